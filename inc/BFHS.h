@@ -0,0 +1,38 @@
+#pragma once
+#include <deque>
+#include "SingleAgentSolver.h"
+
+
+// Breadth-first heuristic search (Zhou & Hansen 2006) with a memory budget. Each iteration is a breadth-first search
+// that prunes nodes whose f-value exceeds an upper bound U, so the goal is found at its optimal depth once U >= C*.
+// Layers are kept for path reconstruction while they fit into the budget. When they do not, the newest layer becomes
+// the relay layer: every later node remembers its ancestor in that layer, all but the two newest layers are dropped,
+// and the path is recovered by solving start->relay and relay->goal recursively (divide and conquer).
+class BFHS: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "BFHS"; }
+
+	int num_of_relays = 0; // number of divide-and-conquer splits
+	bool out_of_memory = false;
+
+	BFHS(const Instance& instance, int agent, int max_memory_mb):
+		SingleAgentSolver(instance, agent), max_memory((uint64_t)max_memory_mb << 20) {}
+
+private:
+	enum search_result { FOUND, FOUND_RELAY, NOT_FOUND, OUT_OF_MEMORY };
+
+	uint64_t max_memory; // in bytes
+
+	// layers of the current breadth-first search (location -> ancestor in the relay layer, or -1 without relay)
+	std::deque< unordered_map<int, int> > layers;
+
+	// append an optimal path from start to goal (excluding start); false if there is none
+	bool solve(int start, int goal, vector<int>& path);
+	// one breadth-first search bounded by upper_bound
+	search_result search(int start, int goal, int upper_bound, int& next_bound, int& relay, vector<int>& path);
+	uint64_t getMemoryUsage() const;
+};
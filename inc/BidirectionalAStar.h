@@ -0,0 +1,54 @@
+#pragma once
+#include <queue>
+#include "SingleAgentSolver.h"
+
+
+// MM (Holte et al. 2016): bidirectional heuristic search that always meets in the middle.
+// A node n in direction d is expanded in the order of pr_d(n) = max(f_d(n), 2 g_d(n)), and the search stops
+// once the best solution U found so far is no larger than max(C, fminF, fminB, gminF + gminB + 1).
+class BidirectionalAStar: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "MM"; }
+
+	uint64_t num_expanded_forward = 0;
+	uint64_t num_expanded_backward = 0;
+
+	BidirectionalAStar(const Instance& instance, int agent):
+		SingleAgentSolver(instance, agent) {}
+
+private:
+	enum direction_t { FORWARD, BACKWARD, DIRECTION_COUNT };
+
+	// search state of a location shared by both directions
+	struct State
+	{
+		int g_val[DIRECTION_COUNT] = {MAX_COST, MAX_COST};
+		int parent[DIRECTION_COUNT] = {-1, -1};
+		bool closed[DIRECTION_COUNT] = {false, false};
+	};
+	vector<State> states;
+
+	// (key, -g_val, location), so ties are broken towards larger g_vals;
+	// an entry is stale once its location is closed or reached with a smaller g_val
+	typedef tuple<int, int, int> entry_t;
+	typedef std::priority_queue< entry_t, vector<entry_t>, std::greater<entry_t> > queue_t;
+	queue_t pr_queue[DIRECTION_COUNT]; // ordered by pr
+	queue_t f_queue[DIRECTION_COUNT]; // ordered by f
+	queue_t g_queue[DIRECTION_COUNT]; // ordered by g
+
+	int best_cost = MAX_COST; // U
+	int meeting_location = -1;
+
+	int getTarget(int dir) const { return dir == FORWARD ? goal_location : start_location; }
+	bool isStale(int dir, const entry_t& entry) const;
+	int getMinKey(int dir, queue_t& queue) const; // MAX_COST if the queue has no valid entry
+	void pushNode(int dir, int loc, int g_val, int parent);
+	void expandNode(int dir);
+
+	// Updates the path datamember
+	void updatePath(vector<PathEntry> &path) const;
+};
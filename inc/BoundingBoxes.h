@@ -0,0 +1,63 @@
+#pragma once
+#include "SpaceTimeAStar.h"
+
+
+// Geometric containers (Wagner, Willhalm & Zaroliagis 2005) for 4-neighbor grids: for every free cell and move, the
+// bounding box of the goals whose shortest path from the cell starts with that move. Each goal is assigned to one such
+// move (the first one found by a BFS from the cell), so that, from every cell, a shortest path to any goal only takes
+// moves whose boxes contain the goal, and a search that skips the other moves is still optimal.
+// The boxes are indexed by row-major location (4 x 8 bytes per cell), and files are memory-mapped.
+class BoundingBoxes
+{
+public:
+	struct Box
+	{
+		uint16_t min_row, max_row, min_col, max_col; // empty if min_row > max_row
+	};
+	double preprocessing_time = 0;
+
+	// one BFS per free cell, run by num_of_threads threads (empty if the map has more than UINT16_MAX rows or columns)
+	BoundingBoxes(const Instance& instance, int num_of_threads = 1);
+	// memory-map the boxes saved in fileName (empty if the file does not match the instance)
+	BoundingBoxes(const Instance& instance, const string& fileName);
+
+	bool empty() const { return boxes == nullptr; }
+	bool save(const string& fileName) const;
+	inline bool contains(int loc, int direction, int goal_row, int goal_col) const
+	{
+		const Box& box = boxes[((size_t)instance.getRowCoordinate(loc) * instance.num_of_cols +
+			instance.getColCoordinate(loc)) * Instance::DIRECTION_COUNT + direction];
+		return box.min_row <= goal_row && goal_row <= box.max_row && box.min_col <= goal_col && goal_col <= box.max_col;
+	}
+	// same as Instance::getSuccessors, but only with the moves whose boxes contain goal
+	int getSuccessors(int curr, int goal, int neighbors[4], int h_vals[4]) const;
+
+private:
+	const Instance& instance;
+	vector<Box> storage;
+	const Box* boxes = nullptr;
+	shared_ptr<const void> mapping; // keeps the memory-mapped file alive
+
+	void search(int source, vector<uint32_t>& visited, uint32_t generation, vector<uint8_t>& first_moves,
+		vector<int>& queue);
+};
+
+
+// Bounding-box file: BOUNDING_BOXES_MAGIC, #rows and #cols (int32 each), the hash of the map (uint64), then the boxes
+// as Box structures.
+#define BOUNDING_BOXES_MAGIC "PASTARBB"
+#define BOUNDING_BOXES_HEADER_SIZE 24
+
+
+// A* that only generates the moves whose bounding boxes contain its goal
+class BoundingBoxAStar: public SpaceTimeAStar
+{
+public:
+	string getName() const { return "BBAStar"; }
+
+	BoundingBoxAStar(const Instance& instance, int agent, const BoundingBoxes& boxes, SearchContext* context = nullptr):
+		SpaceTimeAStar(instance, agent, context)
+	{
+		bounding_boxes = &boxes;
+	}
+};
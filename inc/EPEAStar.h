@@ -0,0 +1,89 @@
+#pragma once
+#include "SingleAgentSolver.h"
+
+
+// Move-operator table for EPEA*. With the Manhattan heuristic every move changes f by 0 (towards the goal) or 2
+// (away from it), so the successors of a cell with a given delta-f are determined by the moves that are valid
+// in the cell and the moves that point towards the goal. Both are 4-bit masks over (NORTH, EAST, SOUTH, WEST).
+class OperatorTable
+{
+public:
+	enum move_t { NORTH, EAST, SOUTH, WEST, MOVE_COUNT };
+	struct Operators
+	{
+		int num_of_moves = 0;
+		int moves[MOVE_COUNT];
+	};
+
+	vector<unsigned char> valid_moves; // mask of the moves that stay on a free cell, for each location
+
+	OperatorTable(const Instance& instance);
+
+	// mask of the moves from loc that decrease the Manhattan distance to goal
+	unsigned char getTowardMoves(int loc, int goal) const;
+	// moves with delta-f = 2 * delta_index (delta_index is 0 or 1)
+	const Operators& getOperators(int loc, unsigned char toward_moves, int delta_index) const
+	{
+		return operators[valid_moves[loc]][toward_moves][delta_index];
+	}
+	int getNextLocation(int loc, int move) const { return instance.getAdjacent(loc, move_directions[move]); }
+
+private:
+	const Instance& instance;
+	int move_directions[MOVE_COUNT]; // Instance::direction_t of each move
+	Operators operators[1 << MOVE_COUNT][1 << MOVE_COUNT][2];
+};
+
+
+class EPEANode: public LLNode
+{
+public:
+	int stored_f_val; // F: the f-value of the successors that the next expansion generates
+
+	// OPEN is ordered by stored f-values, and then by h-values
+	struct compare_node
+	{
+		// returns true if n1 > n2 (note -- this gives us *min*-heap).
+		bool operator()(const EPEANode* n1, const EPEANode* n2) const
+		{
+			if (n1->stored_f_val == n2->stored_f_val)
+				return n1->h_val >= n2->h_val;
+			return n1->stored_f_val >= n2->stored_f_val;
+		}
+	};
+
+	typedef pairing_heap< EPEANode*, compare<compare_node> >::handle_type open_handle_t;
+	open_handle_t open_handle;
+
+	EPEANode(int loc, int g_val, int h_val, LLNode* parent, int timestep):
+		LLNode(loc, g_val, h_val, parent, timestep), stored_f_val(g_val + h_val) {}
+};
+
+
+// Enhanced Partial Expansion A* (Felner et al. 2012): an expansion only generates the successors whose f-value
+// equals the stored F of the node and puts the node back into OPEN with the next F, so successors that are never
+// needed are never allocated. Wait moves are skipped, since they always reach a node that has been generated.
+// The delta-f classes assume the Manhattan heuristic.
+class EPEAStar: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "EPEAStar"; }
+
+	EPEAStar(const Instance& instance, int agent, const OperatorTable& operators):
+		SingleAgentSolver(instance, agent), operators(operators) {}
+
+private:
+	const OperatorTable& operators;
+
+	typedef pairing_heap< EPEANode*, compare<EPEANode::compare_node> > heap_open_t;
+	heap_open_t open_list;
+	unordered_map<int, EPEANode*> allNodes_table; // location -> node
+
+	void updatePath(const LLNode* goal, vector<PathEntry> &path);
+	inline EPEANode* popNode();
+	inline void pushNode(EPEANode* node);
+	void releaseNodes();
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <future>
+#include "SingleAgentSolver.h"
+
+
+struct ExternalRecord
+{
+	int location;
+	int parent; // -1 for the start node
+};
+
+
+// consecutive records of a bucket in a segment file
+struct ExternalExtent
+{
+	int fd;
+	off_t offset; // in records
+	uint64_t num_of_records;
+};
+
+
+// A bucket of records with the same (g, h). The oldest records are in extents on disk, the newest ones in its buffer.
+struct ExternalBucket
+{
+	vector<ExternalExtent> extents;
+	vector<ExternalRecord> buffer;
+	uint64_t size = 0; // number of records on disk and in the buffer
+};
+
+
+// sequential reader of a bucket that prefetches the next block from disk asynchronously and then reads its buffer
+class BucketReader
+{
+public:
+	BucketReader(const ExternalBucket* bucket, size_t block_records);
+	~BucketReader();
+
+	bool empty() const { return pos >= block.size(); }
+	const ExternalRecord& top() const { return block[pos]; }
+	void pop();
+
+private:
+	const ExternalBucket* bucket;
+	size_t pos = 0;
+	size_t extent_index = 0; // next block to read from disk
+	uint64_t extent_pos = 0;
+	vector<ExternalRecord> block;
+	vector<ExternalRecord> next_block;
+	std::future<void> prefetch;
+
+	void readBlock(vector<ExternalRecord>& buffer);
+	void nextBlock();
+};
+
+
+// External-memory A* (Edelkamp, Jabbar & Schroedl 2004). OPEN and CLOSED are partitioned into buckets of nodes with
+// the same (g, h). Buckets are buffered in memory; whenever the buffers exceed the memory budget, they are appended
+// one after another to a segment file in one sequential pass (grid buckets are too small for a file each).
+// Buckets are expanded in (f, g) order. An OPEN bucket is sorted externally (sorted runs plus a k-way merge) and its
+// duplicates are removed by merging it with the CLOSED buckets (g - 1, h) and (g - 2, h), which is sufficient for
+// undirected graphs and consistent heuristics (delayed duplicate detection). The path is recovered by binary
+// searches in the CLOSED buckets.
+class ExternalAStar: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "ExternalA*"; }
+
+	uint64_t num_of_buckets = 0; // number of expanded buckets
+	uint64_t bytes_written = 0;
+
+	ExternalAStar(const Instance& instance, int agent, int max_memory_mb, const string& directory):
+		SingleAgentSolver(instance, agent), max_memory((uint64_t)max_memory_mb << 20), root_directory(directory) {}
+
+private:
+	uint64_t max_memory; // in bytes; half for the bucket buffers and half for sorting
+	string root_directory;
+	string directory; // temporary directory of the current search
+	vector<int> segments; // file descriptors of the (already unlinked) segment files
+	uint64_t segment_size = 0; // number of records in the last segment
+
+	map< pair<int, int>, ExternalBucket> open_buckets; // keyed by (f, g)
+	map< pair<int, int>, ExternalBucket> closed_buckets; // keyed by (g, h), until they are written
+	vector< vector< pair<int, ExternalExtent> > > closed_extents; // g -> (h, extent) of the written CLOSED buckets
+	uint64_t open_size = 0;
+	uint64_t buffered_records = 0;
+
+	// sort, deduplicate and expand OPEN bucket (g_val, h_val); return true and the goal record if it contains the goal
+	bool expandBucket(int g_val, int h_val, ExternalBucket& bucket, ExternalRecord& goal);
+	void push(ExternalBucket& bucket, const ExternalRecord& record);
+	void flush(const vector<ExternalBucket*>& buckets); // append the buffers to the current segment
+	void spill(); // flush buffers until they fit into the memory budget
+	void release(const ExternalBucket& bucket) const; // free the disk space of a bucket that has been read
+	const ExternalBucket* getClosedBucket(int g_val, int h_val, ExternalBucket& sealed) const;
+	bool findRecord(int location, int g_val, ExternalRecord& record) const;
+	size_t getBlockSize(int num_of_streams) const;
+};
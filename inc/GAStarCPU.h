@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include "GAStar.h"
+
+
+// reusable barrier for a fixed number of threads
+class StepBarrier
+{
+public:
+	explicit StepBarrier(int num_of_threads): num_of_threads(num_of_threads) {}
+	void wait();
+
+private:
+	std::mutex lock;
+	std::condition_variable condition;
+	int num_of_threads;
+	int num_of_waiting = 0;
+	uint64_t generation = 0;
+};
+
+
+// CPU port of GA* (Zhou & Zeng 2015), the algorithm of GAStar.cu. There are k = num_of_threads * queues_per_thread
+// binary heaps, each owned by one thread, and every step is bulk-synchronous:
+// (1) every heap extracts its best node and expands it into the successor list S;
+// (2) S is deduplicated in parallel against the multi-hash table H (HASH_FUNS hash functions, slots updated by
+//     compare-exchange);
+// (3) the survivors are distributed round-robin over the heaps.
+// The search stops once the best goal node extracted so far has an f-val no larger than the minimal f-val in the heaps.
+// The successors get their h-vals in step (1), in parallel: the Manhattan distances, or goal_distances if it is set.
+// The RRA* heuristic is not supported, because each lookup may extend its reverse search, which has no lock.
+class GAStarCPU: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "GA*"; }
+
+	uint64_t num_of_steps = 0;
+
+	GAStarCPU(const Instance& instance, int agent, int num_of_threads, int queues_per_thread = 4);
+
+private:
+	struct compare_node
+	{
+		// lower priority: larger f-val, then smaller g-val
+		bool operator()(const GNode* n1, const GNode* n2) const
+		{
+			int f1 = n1->g_val + n1->h_val, f2 = n2->g_val + n2->h_val;
+			return f1 > f2 || (f1 == f2 && n1->g_val < n2->g_val);
+		}
+	};
+	typedef std::priority_queue<GNode*, vector<GNode*>, compare_node> heap_t;
+
+	struct ThreadData
+	{
+		vector<heap_t> heaps;
+		vector<GNode*> successors; // this thread's part of S
+		std::deque<GNode> nodes; // all nodes generated by this thread
+		GNode* goal = nullptr; // best goal node extracted by this thread
+		int min_f_val = MAX_COST;
+		uint64_t expanded = 0;
+		uint64_t generated = 0;
+	};
+
+	int num_of_threads;
+	int queues_per_thread;
+	int num_of_queues;
+	vector<ThreadData> threads;
+	std::unique_ptr<std::atomic<GNode*>[]> hash_table; // H
+	size_t hash_size; // a power of two
+	vector<GNode*> successors; // S after deduplication
+	GNode* best_goal = nullptr;
+	bool done = false;
+
+	void search(int thread_id, StepBarrier& barrier);
+	void expand(ThreadData& data);
+	void deduplicate(ThreadData& data);
+	void push(int thread_id);
+	bool isStale(const GNode* node) const; // H holds a node with a smaller g-val at the same location
+	size_t getHash(int j, int location) const;
+};
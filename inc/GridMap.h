@@ -0,0 +1,40 @@
+#pragma once
+#include "common.h"
+
+
+// Bit-packed obstacle map (bit loc is set iff loc is an obstacle). The bits either live in the object itself
+// or in read-only external memory, e.g., a memory-mapped binary map file.
+class GridMap
+{
+public:
+	GridMap() {}
+	GridMap(const GridMap& other) { *this = other; }
+	GridMap& operator=(const GridMap& other);
+
+	inline bool operator[](int loc) const { return (words[loc >> 6] >> (loc & 63)) & 1; }
+	void set(int loc, bool obstacle);
+	void resize(int size, bool obstacle = false);
+	int size() const { return map_size; }
+
+	// use external bits (owner keeps them alive, e.g., the munmap deleter of a mapping)
+	void attach(const uint64_t* bits, int size, shared_ptr<const void> owner);
+	bool isAttached() const { return owner != nullptr; }
+
+	const uint64_t* data() const { return words; }
+	static size_t getNumOfWords(size_t size) { return (size + 63) / 64; }
+
+private:
+	int map_size = 0;
+	vector<uint64_t> storage;
+	const uint64_t* words = nullptr;
+	shared_ptr<const void> owner; // keeps the external bits alive
+};
+
+
+// Binary map file: BINARY_MAP_MAGIC, #rows and #cols (int32 each), then the bits of GridMap as uint64 words.
+#define BINARY_MAP_MAGIC "PASTARBM"
+#define BINARY_MAP_HEADER_SIZE 16
+
+// memory-map a binary map file; returns false if fileName is not a binary map
+bool loadBinaryMap(const string& fileName, int& num_of_rows, int& num_of_cols, GridMap& map);
+bool saveBinaryMap(const string& fileName, int num_of_rows, int num_of_cols, const GridMap& map);
@@ -17,8 +17,9 @@ public:
 
 	string getName() const { return "HDAStar"; }
 
-	HDAStar(const Instance& instance, int agent, int nproc_, int pid_):
-		SingleAgentSolver(instance, agent)
+	// the search is distributed over the nproc_ processes of comm, of which this is process pid_
+	HDAStar(const Instance& instance, int agent, int nproc_, int pid_, MPI_Comm comm = MPI_COMM_WORLD):
+		SingleAgentSolver(instance, agent), comm(comm)
 	{ 
 		nproc = nproc_; 
 		pid = pid_; 
@@ -28,6 +29,7 @@ private:
 	// define typedefs and handles for heap
 	typedef pairing_heap< AStarNode*, compare<AStarNode::compare_node> > heap_open_t;
 	heap_open_t open_list;
+	MPI_Comm comm;
 	int pid;
 	bool dst_found = false;
 	bool in_barrier_mode = false;
@@ -0,0 +1,74 @@
+#pragma once
+#include "SingleAgentSolver.h"
+#include "SpaceTimeAStar.h"
+
+
+// HPA* abstraction: the grid is split into cluster_size x cluster_size clusters, every entrance between two
+// adjacent clusters contributes one or two transitions (pairs of abstract nodes joined by an inter-edge of cost 1),
+// and the abstract nodes of a cluster are connected by intra-edges whose costs are the cached distances inside it
+class HPAGraph
+{
+	const Instance& instance;
+
+public:
+	int cluster_size;
+	int num_of_cluster_rows;
+	int num_of_cluster_cols;
+	vector<int> nodes; // location of each abstract node
+	vector<int> node_id; // abstract node id of each location (-1 if it is not an abstract node)
+	vector< vector< pair<int, int> > > edges; // (neighbor node id, cost) of each abstract node
+	vector< vector<int> > cluster_nodes; // abstract node ids of each cluster
+	double preprocessing_time = 0;
+
+	// build the abstraction, computing the intra-cluster distances with num_of_threads threads
+	HPAGraph(const Instance& instance, int cluster_size, int num_of_threads = 1);
+	// load the abstraction from fileName (returns an empty graph if the file does not match the instance)
+	HPAGraph(const Instance& instance, const string& fileName);
+
+	bool empty() const { return nodes.empty(); }
+	int getNumOfNodes() const { return (int)nodes.size(); }
+	int getNumOfEdges() const;
+	int getCluster(int loc) const
+	{
+		return (instance.getRowCoordinate(loc) / cluster_size) * num_of_cluster_cols +
+			instance.getColCoordinate(loc) / cluster_size;
+	}
+
+	// BFS from loc inside its cluster and collect (node id, distance) of the reachable abstract nodes;
+	// target_distance is set to the distance to target (MAX_COST if it is outside the cluster or unreachable)
+	void getIntraDistances(int loc, vector< pair<int, int> >& distances, int target, int& target_distance) const;
+
+	bool save(const string& fileName) const;
+
+private:
+	void addEntrances();
+	void addTransition(int loc1, int loc2);
+	int addNode(int loc);
+	void connectCluster(int cluster);
+};
+
+
+class HPAStar: public SingleAgentSolver
+{
+public:
+	// search the abstract graph and refine each abstract edge with SpaceTimeAStar
+	// (the path is near-optimal, so both functions return the same path)
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "HPAStar"; }
+
+	// the refinements share context (or a context allocated for this query if there is none)
+	HPAStar(const Instance& instance, int agent, const HPAGraph& graph, bool smooth = false,
+		SearchContext* context = nullptr):
+		SingleAgentSolver(instance, agent), graph(graph), smooth(smooth), context(context) {}
+
+private:
+	const HPAGraph& graph;
+	bool smooth; // shortcut the refined path with monotone paths
+	SearchContext* context;
+
+	// Updates the path datamember
+	void updatePath(const vector<int>& abstract_path, vector<PathEntry> &path);
+	void smoothPath(vector<PathEntry> &path) const;
+};
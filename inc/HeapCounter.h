@@ -0,0 +1,6 @@
+#pragma once
+#include <cstdint>
+
+
+// number of calls to the global operator new so far; defined in HeapCounter.cpp, which is only linked into pastar
+uint64_t getNumOfHeapAllocations();
@@ -0,0 +1,56 @@
+#pragma once
+#include <future>
+#include <mutex>
+#include "Instance.h"
+
+
+// Exact heuristic tables (the BFS distances of every location to a goal) of the most recently used goals, shared by
+// the queries of a run. Tables are evicted in LRU order to stay within max_memory_mb; a goal whose table does not fit
+// gets none, and its solvers use the Manhattan distance. If directory is not empty, every computed table is also
+// saved there, and later runs on the same map memory-map it instead of searching again.
+// get may be called by several threads at once; a table is loaded or computed outside the lock, and the other callers
+// of the same goal wait for it.
+class HeuristicCache
+{
+public:
+	uint64_t num_of_hits = 0;
+	uint64_t num_of_misses = 0; // tables loaded or computed
+	uint64_t num_of_loads = 0; // tables memory-mapped from files
+	uint64_t num_of_evictions = 0;
+	double computation_time = 0;
+
+	HeuristicCache(const Instance& instance, int max_memory_mb, int num_of_threads = 1, const string& directory = "");
+
+	// distances[loc] = distance from loc to goal (MAX_COST if it is unreachable or an obstacle), or nullptr if the
+	// table does not fit in the budget. The table stays valid while the pointer is held, even if it is evicted.
+	shared_ptr<const int> get(int goal);
+
+private:
+	const Instance& instance;
+	size_t capacity; // number of tables
+	int num_of_threads;
+	string directory;
+	uint64_t map_hash;
+
+	std::mutex lock;
+	struct Entry
+	{
+		shared_ptr<const int> distances;
+		list<int>::iterator position;
+	};
+	unordered_map<int, Entry> tables;
+	list<int> goals; // from the most to the least recently used
+	unordered_map< int, std::shared_future< shared_ptr<const int> > > pending; // tables being loaded or computed
+
+	// frontier-based BFS from goal; each large level is split among num_of_threads threads, started once per table
+	void computeTable(int goal, int* distances) const;
+	string getFileName(int goal) const;
+	shared_ptr<const int> loadTable(int goal) const;
+	bool saveTable(int goal, const int* distances) const;
+};
+
+
+// Heuristic table file: HEURISTIC_TABLE_MAGIC, #rows, #cols, tile size and goal (row-major, int32 each), the hash of the
+// map (uint64), then the distances (int32) of all location ids of the instance.
+#define HEURISTIC_TABLE_MAGIC "PASTARHT"
+#define HEURISTIC_TABLE_HEADER_SIZE 32
@@ -1,5 +1,7 @@
 #pragma once
 #include"common.h"
+#include"GridMap.h"
+#include"MapIndex.h"
 
 
 // Currently only works for undirected unweighted 4-nighbor grids
@@ -8,29 +10,73 @@ class Instance
 public:
 	int num_of_cols;
 	int num_of_rows;
-	int map_size;
-	vector<bool> my_map;
+	int map_size; // number of location ids (including the padding of the last row and column of tiles)
+	GridMap my_map;
+	// Locations are numbered tile by tile: the map is split into tiles of 2^tile_shift x 2^tile_shift cells that are
+	// numbered row by row, and the cells of each tile are numbered row by row, so that nearby cells have nearby ids.
+	// tile_shift = 0 is the row-major layout. The padding cells are obstacles. Files always use row-major coordinates.
+	int tile_shift = 0;
+	int tile_mask = 0;
+	int num_of_tile_cols = 0;
+	enum direction_t { RIGHT, LEFT, DOWN, UP, DIRECTION_COUNT };
+	MapIndex map_index; // connected components and dead ends, built when the map is loaded
 
 	// enum valid_moves_t { NORTH, EAST, SOUTH, WEST, WAIT_MOVE, MOVE_COUNT };  // MOVE_COUNT is the enum's size
 
 	Instance(){}
 	Instance(const string& map_fname, const string& agent_fname, 
-		int num_of_agents = 0, int num_of_rows = 0, int num_of_cols = 0, int num_of_obstacles = 0, int warehouse_width = 0);
+		int num_of_agents = 0, int num_of_rows = 0, int num_of_cols = 0, int num_of_obstacles = 0, int warehouse_width = 0,
+		int tile_size = 1);
+	// a map without agents, given row by row (cell i is an obstacle iff obstacles[i] != 0)
+	Instance(int num_of_rows, int num_of_cols, const uint8_t* obstacles, int tile_size = 1);
+	// an instance written by copyToShared, whose map and map index are used in place (owner keeps them alive)
+	Instance(const char* shared, shared_ptr<const void> owner);
+
+	// the map, agents and map index as a flat array of bytes, e.g., to share one copy between processes
+	size_t getSharedSize() const;
+	void copyToShared(char* shared) const;
 
 
 	void printAgents() const;
+	bool saveBinaryMap(const string& fname) const;
+	// FNV-1a of the size and the row-major obstacles, so that preprocessing files of other maps are not used
+	uint64_t getMapHash() const;
 
 
 		inline bool isObstacle(int loc) const { return my_map[loc]; }
 		inline bool validMove(int curr, int next) const;
 		list<int> getNeighbors(int curr) const;
+		int getNeighbors(int curr, int neighbors[4]) const; // without allocations, returns the number of neighbors
+		// the neighbors of curr (in the order of getNeighbors) and their Manhattan distances to goal, computed for the
+		// 4 moves at once with SSE2 (or scalar code without it); returns the number of neighbors
+		int getSuccessors(int curr, int goal, int neighbors[4], int h_vals[4]) const;
+		// find a path of length getManhattanDistance(from, to) inside the bounding box of from and to,
+		// append it to path (excluding from) and return true if such a path exists
+		bool getMonotonePath(int from, int to, vector<int>& path) const;
 
 
-		inline int linearizeCoordinate(int row, int col) const { return ( this->num_of_cols * row + col); }
-		inline int getRowCoordinate(int id) const { return id / this->num_of_cols; }
-		inline int getColCoordinate(int id) const { return id % this->num_of_cols; }
-		inline pair<int, int> getCoordinate(int id) const { return make_pair(id / this->num_of_cols, id % this->num_of_cols); }
+		inline int linearizeCoordinate(int row, int col) const
+		{
+			int tile = (row >> tile_shift) * num_of_tile_cols + (col >> tile_shift);
+			return (((tile << tile_shift) | (row & tile_mask)) << tile_shift) | (col & tile_mask);
+		}
+		inline int getRowCoordinate(int id) const
+		{
+			return ((id >> 2 * tile_shift) / num_of_tile_cols) << tile_shift | ((id >> tile_shift) & tile_mask);
+		}
+		inline int getColCoordinate(int id) const
+		{
+			return ((id >> 2 * tile_shift) % num_of_tile_cols) << tile_shift | (id & tile_mask);
+		}
+		inline pair<int, int> getCoordinate(int id) const { return make_pair(getRowCoordinate(id), getColCoordinate(id)); }
 		inline int getCols() const { return num_of_cols; }
+		// the location next to loc in the given direction, without divisions (the caller checks the map boundary)
+		inline int getAdjacent(int loc, int direction) const
+		{
+			int in_tile = direction < DOWN ? (loc & tile_mask) : ((loc >> tile_shift) & tile_mask);
+			bool cross = in_tile == ((direction & 1) ? 0 : tile_mask); // leaves the tile
+			return loc + (cross ? cross_tile_offsets[direction] : inner_tile_offsets[direction]);
+		}
 
 		inline int getManhattanDistance(int loc1, int loc2) const
 		{
@@ -49,22 +95,20 @@ public:
 	int getDegree(int loc) const
 	{
 		assert(loc >= 0 && loc < map_size && !my_map[loc]);
-		int degree = 0;
-		if (0 < loc - num_of_cols && !my_map[loc - num_of_cols])
-			degree++;
-		if (loc + num_of_cols < map_size && !my_map[loc + num_of_cols])
-			degree++;
-		if (loc % num_of_cols > 0 && !my_map[loc - 1])
-			degree++;
-		if (loc % num_of_cols < num_of_cols - 1 && !my_map[loc + 1])
-			degree++;
-		return degree;
+		int neighbors[4];
+		return getNeighbors(loc, neighbors);
 	}
 
 	int getDefaultNumberOfAgents() const { return num_of_agents; }
+	int getStartLocation(int agent) const { return start_locations[agent]; }
+	int getGoalLocation(int agent) const { return goal_locations[agent]; }
 
 private:
 	  // int moves_offset[MOVE_COUNT];
+	  // offsets of getAdjacent inside a tile and across the tile boundary, per direction
+	  int inner_tile_offsets[DIRECTION_COUNT];
+	  int cross_tile_offsets[DIRECTION_COUNT];
+
 	  string map_fname;
 	  string agent_fname;
 
@@ -72,6 +116,8 @@ private:
 	  vector<int> start_locations;
 	  vector<int> goal_locations;
 
+	  void setTileSize(int tile_size); // tile_shift and tile_mask
+	  void setLayout(); // map_size and the offsets, for num_of_rows x num_of_cols and tile_shift
 	  bool loadMap();
 	  void printMap() const;
 	  void saveMap() const;
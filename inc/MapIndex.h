@@ -0,0 +1,94 @@
+#pragma once
+#include "common.h"
+
+class Instance;
+
+#define MAP_INDEX_HEADER_SIZE 24
+
+
+// Preprocessing index of the free cells of a map, built when the instance is loaded:
+// - the connected components, so that queries between two components fail in O(1);
+// - the block-cut tree of each component, whose nodes are its blocks (biconnected components) and its articulation
+//   cells, with an edge between each articulation cell and the blocks that contain it. A simple path between two cells
+//   only visits the blocks on the tree path between them, so every other block is a dead end (a room with a single
+//   door, a dead-end corridor, ...) that a search between the two cells can skip without losing optimality.
+// Queries are const and can be answered by several threads at once.
+class MapIndex
+{
+public:
+	// the tree path between the nodes of a start and a goal
+	struct Corridor
+	{
+		int source = ALL;
+		int target = ALL;
+		int top = ALL; // lowest common ancestor of source and target; UNREACHABLE if they are not connected
+		bool isReachable() const { return top != UNREACHABLE; }
+	};
+
+	int num_of_components = 0;
+	int num_of_blocks = 0;
+	int num_of_articulations = 0;
+	double preprocessing_time = 0;
+
+	MapIndex() {}
+	MapIndex(const MapIndex& other) { *this = other; }
+	MapIndex& operator=(const MapIndex& other);
+
+	void build(const Instance& instance);
+	bool empty() const { return cell_nodes == nullptr; }
+
+	// the index as a flat array of bytes, e.g., to share one copy between processes
+	size_t getSharedSize() const;
+	void copyToShared(char* shared) const;
+	// use an index written by copyToShared (owner keeps it alive), like GridMap::attach
+	void attach(const char* shared, shared_ptr<const void> owner);
+
+	// the connected component of loc (-1 if it is an obstacle, which only reaches itself)
+	int getComponent(int loc) const { return cell_nodes[loc] < 0 ? -1 : nodes[cell_nodes[loc]].component; }
+	bool isReachable(int from, int to) const
+	{
+		return empty() || from == to || (getComponent(from) >= 0 && getComponent(from) == getComponent(to));
+	}
+	Corridor getCorridor(int start, int goal) const; // O(depth of the tree)
+	inline bool inCorridor(const Corridor& corridor, int loc) const
+	{
+		if (corridor.top == ALL)
+			return true;
+		int node = cell_nodes[loc];
+		if (onPath(corridor, node))
+			return true;
+		// an articulation cell of a block on the path, which is the parent of one of its blocks or of its own node
+		int parent = nodes[node].parent;
+		return nodes[node].articulation && ((parent >= 0 && onPath(corridor, parent)) || nodes[corridor.top].parent == node);
+	}
+
+private:
+	static const int ALL = -2; // the index was not built, so nothing is pruned
+	static const int UNREACHABLE = -1;
+
+	struct TreeNode
+	{
+		int parent; // -1 for the root of a component
+		int first; // preorder number of the node
+		int last; // largest preorder number in its subtree
+		int component;
+		bool articulation; // an articulation cell (or else a block)
+	};
+	// in the storage vectors, or in external memory (see attach)
+	const TreeNode* nodes = nullptr;
+	const int* cell_nodes = nullptr; // the articulation node of each articulation cell, the block of any other free cell
+	int num_of_nodes = 0;
+	int num_of_cells = 0;
+	vector<TreeNode> node_storage;
+	vector<int> cell_node_storage;
+	shared_ptr<const void> owner; // keeps the external memory alive
+
+	bool isAncestor(int ancestor, int node) const
+	{
+		return nodes[ancestor].first <= nodes[node].first && nodes[node].last <= nodes[ancestor].last;
+	}
+	bool onPath(const Corridor& corridor, int node) const
+	{
+		return isAncestor(corridor.top, node) && (isAncestor(node, corridor.source) || isAncestor(node, corridor.target));
+	}
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include "SingleAgentSolver.h"
+
+
+// Shared-memory parallel A* on a MultiQueue (Rihani, Sanders & Dementiev 2015): queues_per_thread * num_of_threads
+// heaps, each protected by its own lock. A thread pushes into a random heap and pops from the better of two random
+// heaps, which balances the load without partitioning the state space. The best g-value and the parent of every
+// location are packed into one atomic word that is only ever decreased, so stale heap entries are dropped when popped.
+// The search stops once no thread is expanding and the smallest f-value in all heaps is no smaller than the cost of
+// the incumbent, which makes the path optimal.
+// The heuristic is the Manhattan distance, or goal_distances if it is set: the threads only read that table. The RRA*
+// heuristic is not supported, because its reverse search is resumed by the lookups of every thread.
+class MultiQueueAStar: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "MQA*"; }
+
+	MultiQueueAStar(const Instance& instance, int agent, int num_of_threads, int queues_per_thread = 2);
+
+private:
+	struct Entry
+	{
+		int f_val;
+		int g_val;
+		int location;
+		// lower priority: larger f-val, then smaller g-val
+		bool operator<(const Entry& other) const
+		{
+			return f_val > other.f_val || (f_val == other.f_val && g_val < other.g_val);
+		}
+	};
+
+	struct Queue
+	{
+		std::mutex lock;
+		std::priority_queue<Entry> heap;
+		std::atomic<int> min_f_val; // f-val of the top entry (MAX_COST if empty), read without the lock
+		std::atomic<int> size;
+		char padding[64]; // keep the locks of different heaps in different cache lines
+	};
+
+	int num_of_threads;
+	int num_of_queues;
+	std::unique_ptr<Queue[]> queues;
+	std::unique_ptr<std::atomic<uint64_t>[]> states; // location -> (g-val << 32) | parent
+
+	std::atomic<int> num_of_busy_threads;
+	std::atomic<uint64_t> num_of_operations; // number of pushes and pops, to detect a quiescent state
+	std::atomic<bool> done;
+
+	void search(int thread_id, uint64_t& expanded, uint64_t& generated);
+	bool pop(Entry& entry, uint64_t& seed);
+	void push(const Entry& entry, uint64_t& seed);
+	bool improve(int location, int g_val, int parent); // true if g_val is smaller than the best g-val of location
+	int getGVal(int location) const { return (int)(states[location].load() >> 32); }
+	int getParent(int location) const { return (int)(uint32_t)states[location].load(); }
+	bool checkTermination();
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "Instance.h"
+
+// 64-bit words per frontier mask, i.e., 64 * MSBFS_MASK_WORDS sources per batch. With 4 words (256 sources, one AVX2
+// vector per mask), the state of a location takes 96 bytes, and the searches were slower on the benchmark maps.
+#ifndef MSBFS_MASK_WORDS
+#define MSBFS_MASK_WORDS 1
+#endif
+
+
+// Bit-parallel multi-source BFS (Then et al. 2014). A batch of 64 * MSBFS_MASK_WORDS sources is searched at once:
+// every location has a mask of the sources that have reached it and a mask of the sources whose frontiers it is on,
+// and each level expands the locations whose frontier masks are not empty, once for all their sources.
+// Sources are batched in Z-order, because nearby sources reach most locations at the same levels.
+// Batches are independent, so num_of_threads threads search different batches.
+class MultiSourceBFS
+{
+public:
+	static const int BATCH_SIZE = 64 * MSBFS_MASK_WORDS;
+	double runtime = 0; // of the last call
+
+	explicit MultiSourceBFS(const Instance& instance, int num_of_threads = 1):
+		instance(instance), num_of_threads(max(num_of_threads, 1)) {}
+
+	// distances[i * targets.size() + j] = distance from sources[i] to targets[j] (MAX_COST if it is unreachable)
+	void computeDistances(const vector<int>& sources, const vector<int>& targets, vector<int>& distances);
+	// distances[i * map_size + loc] = distance from sources[i] to loc (MAX_COST if it is unreachable)
+	void computeDistancesToAll(const vector<int>& sources, vector<int>& distances);
+
+private:
+	const Instance& instance;
+	int num_of_threads;
+
+	struct Mask
+	{
+		uint64_t words[MSBFS_MASK_WORDS];
+	};
+	struct State // of a location
+	{
+		Mask seen; // sources that have reached it
+		Mask visit[2]; // sources whose current (or next) frontiers it is on, alternating between levels
+	};
+
+	// target_ids[loc] is the column of loc in distances (-1 if it is not a target)
+	void search(const vector<int>& sources, const vector<int>& target_ids, int num_of_targets,
+		vector<int>& distances) const;
+	// search from sources[rows[0]], ..., sources[rows[num_of_sources - 1]]
+	void searchBatch(const vector<int>& sources, const int* rows, int num_of_sources, const vector<int>& target_ids,
+		int num_of_targets, vector<int>& distances, vector<State>& states) const;
+};
+
+
+// Distance matrix file: DISTANCE_MATRIX_MAGIC, #rows and #cols (int32 each), then the distances as int32 row by row
+// (-1 if unreachable).
+#define DISTANCE_MATRIX_MAGIC "PASTARDM"
+
+bool saveDistanceMatrix(const string& fileName, int num_of_rows, int num_of_cols, const vector<int>& distances);
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include "SingleAgentSolver.h"
+
+
+// Parallel Best-NBlock-First (Burns, Lemons, Ruml & Zhou 2010). The grid is split into nblocks of
+// nblock_size x nblock_size cells, each with its own OPEN and CLOSED lists. Successors of a cell stay in its nblock or
+// in the 4 adjacent ones (its duplicate detection scope), so two nblocks interfere if they are at most 2 nblocks apart.
+// A thread acquires the free nblock with the best f-val (not in use, sigma = 0, i.e., no interfering nblock in use),
+// expands it without locks, and switches to a better free nblock after every min_expansions expansions.
+// Nodes with f-vals no smaller than the incumbent are pruned, so the search ends, optimally, once no nblock is in use
+// and none is free.
+// The heuristic (the Manhattan distance, or goal_distances if it is set) also orders the free nblocks by their best
+// f-vals. The RRA* heuristic is not supported: the nblocks are expanded without locks, but its lookups write to the
+// reverse search.
+class PBNF: public SingleAgentSolver
+{
+public:
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "PBNF"; }
+
+	uint64_t num_of_switches = 0; // number of nblock acquisitions
+
+	PBNF(const Instance& instance, int agent, int num_of_threads, int nblock_size, int min_expansions = 32);
+
+private:
+	struct Node
+	{
+		int location;
+		int g_val;
+		int h_val;
+		Node* parent;
+	};
+
+	struct OpenEntry
+	{
+		int f_val;
+		int g_val; // of the node when it was pushed, to skip outdated entries
+		Node* node;
+		// lower priority: larger f-val, then smaller g-val
+		bool operator<(const OpenEntry& other) const
+		{
+			return f_val > other.f_val || (f_val == other.f_val && g_val < other.g_val);
+		}
+	};
+
+	struct NBlock
+	{
+		// search state, only accessed by the thread that holds this nblock or an adjacent one
+		std::priority_queue<OpenEntry> open;
+		unordered_map<int, Node*> nodes;
+		// abstract state, protected by PBNF::lock
+		vector<int> interference; // nblocks whose duplicate detection scopes overlap with this one
+		int sigma = 0; // number of interfering nblocks in use
+		bool in_use = false;
+		int best_f_val = MAX_COST; // f-val of the best open node when the nblock was released
+	};
+
+	int num_of_threads;
+	int nblock_size;
+	int min_expansions;
+	int nblock_rows;
+	int nblock_cols;
+	vector<NBlock> nblocks;
+
+	std::mutex lock;
+	std::condition_variable condition;
+	set< pair<int, int> > free_list; // (best f-val, nblock)
+	std::atomic<int> best_free_f_val; // f-val of the best free nblock, read without the lock
+	int num_in_use = 0;
+	std::atomic<int> incumbent; // cost of the best path found so far
+	std::atomic<uint64_t> num_of_expansions;
+	std::atomic<uint64_t> num_of_generations;
+
+	int getNBlock(int location) const
+	{
+		return instance.getRowCoordinate(location) / nblock_size * nblock_cols +
+			instance.getColCoordinate(location) / nblock_size;
+	}
+	void search();
+	int acquire(int released); // release an nblock (if not -1) and acquire the best free one (-1 if the search is over)
+	void release(int nblock);
+	void updateFreeList(int nblock);
+	int getBestFVal(NBlock& nblock) const; // drops outdated and pruned entries from the top of its OPEN
+	void expand(Node* curr, uint64_t& generated);
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <mutex>
+#include "SpaceTimeAStar.h"
+#include "SubgoalGraph.h"
+#include "HPAStar.h"
+#include "EPEAStar.h"
+#include "BoundingBoxes.h"
+#include "HeuristicCache.h"
+#include "QueryPredictor.h"
+
+
+// Parameters of the single-agent solvers and of their preprocessing (see the options of the driver)
+struct SolverOptions
+{
+	int num_of_threads = 1; // of the parallel solvers and of the preprocessing
+	int cluster_size = 16;
+	int nblock_size = 16;
+	bool smooth = false;
+	int max_memory_mb = 1024;
+	string external_dir = "/tmp";
+	string heuristic = "Manhattan"; // Manhattan, RRA* or BFS
+	int reverse_searches = 16;
+	int heuristic_memory_mb = 256;
+	string heuristic_dir;
+	string abstract_graph_file; // to load (or save) the abstract graph of HPA*
+	string bounding_boxes_file; // to load (or save) the bounding boxes of BB
+	double suboptimality = 1; // of wA*, and of auto on the queries that are not easy
+	string parallel_algo = "MQA*"; // of auto on the queries that are not easy, with several threads
+	double easy_expansions = 100000; // auto runs A* on the queries predicted to expand at most this many nodes
+	string predictor_model; // weights of the predictor of auto (the uncalibrated ones if empty)
+	int screen = 1;
+};
+
+
+// An instance with the preprocessing of the single-agent solvers (subgoal graph, abstract graph, bounding boxes,
+// operator table and heuristic caches), built the first time an algorithm needs it and shared by all its queries.
+// createSolver may be called by several threads at once, except with the RRA* heuristic.
+class PreprocessedMap
+{
+public:
+	const Instance& instance;
+	const SolverOptions options;
+
+	PreprocessedMap(const Instance& instance, const SolverOptions& options);
+
+	static bool isValidAlgorithm(const string& algo);
+	// false if algo cannot search with the heuristic (the delta-f classes of EPEA* assume the Manhattan heuristic, and
+	// the RRA* searches are not thread-safe)
+	static bool supportsHeuristic(const string& algo, const string& heuristic)
+	{
+		if (algo == "EPEA*")
+			return heuristic == "Manhattan";
+		if (algo == "MQA*" || algo == "GA*" || algo == "PBNF")
+			return heuristic != "RRA*";
+		return true;
+	}
+	static bool usesSearchContext(const string& algo)
+	{
+		return algo == "A*" || algo == "wA*" || algo == "HPA*" || algo == "BB" || algo == "auto";
+	}
+	// build the preprocessing of algo now, e.g., so that it is not timed with the first query; false if it cannot be
+	// built for this map (the bounding boxes of a map with more than UINT16_MAX rows or columns)
+	bool prepare(const string& algo);
+	// a solver of algo for the trial (or nullptr if algo is unknown, does not support the heuristic or cannot be
+	// prepared); start and goal (if not negative) replace those of
+	// the trial, and context is used by the algorithms of usesSearchContext
+	SingleAgentSolver* createSolver(const string& algo, int trial, SearchContext* context, int start = -1,
+		int goal = -1);
+
+	// the algorithm of auto for a query: A* if it is predicted to be easy (or its goal is unreachable), else wA* if
+	// options.suboptimality > 1, else options.parallel_algo if there are several threads, else A*
+	string selectAlgorithm(int start, int goal);
+
+	const HeuristicCache* getHeuristicTables() const { return heuristic_tables.get(); }
+	// the exact distances to goal with the BFS heuristic, or else nullptr
+	shared_ptr<const int> getGoalDistances(int goal)
+	{
+		return heuristic_tables != nullptr ? heuristic_tables->get(goal) : nullptr;
+	}
+
+private:
+	std::mutex lock; // of the preprocessing
+	std::unique_ptr<SubgoalGraph> subgoal_graph;
+	std::unique_ptr<OperatorTable> operator_table;
+	std::unique_ptr<HPAGraph> abstract_graph;
+	std::unique_ptr<BoundingBoxes> bounding_boxes;
+	std::unique_ptr<RRAStarCache> reverse_searches;
+	std::unique_ptr<HeuristicCache> heuristic_tables;
+	std::unique_ptr<QueryPredictor> predictor;
+};
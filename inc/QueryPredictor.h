@@ -0,0 +1,44 @@
+#pragma once
+#include "Instance.h"
+
+
+// Cheap features of a query, computed before it is solved
+struct QueryFeatures
+{
+	int manhattan_distance = 0;
+	int landmark_gap = 0; // landmark (ALT) lower bound on the distance minus the Manhattan distance
+	int component_size = 0; // free cells that the start can reach
+	double obstacle_density = 0; // fraction of obstacles around the start and the goal
+};
+
+
+// Predicts the number of A* expansions of a query with a log-linear model of its features:
+// log2(1 + expansions) = weights . (1, log2(1 + Manhattan distance), log2(1 + landmark gap), log2(component size),
+// obstacle density). The landmarks are spread over the largest component by farthest-point selection, and their BFS
+// distances are kept, so the features of a query take O(#landmarks + window size).
+// The weights are calibrated on the results files that ResultWriter writes for A* runs (SingleAgentSolver::getResults).
+class QueryPredictor
+{
+public:
+	static const int NUM_OF_WEIGHTS = 5;
+	double weights[NUM_OF_WEIGHTS] = {0, 1, 1, 0, 0}; // until calibrated: expansions ~ distance * (1 + gap)
+	double preprocessing_time = 0;
+
+	QueryPredictor(const Instance& instance, int num_of_landmarks = 8, int num_of_threads = 1);
+
+	QueryFeatures getFeatures(int start, int goal) const;
+	double predictExpansions(int start, int goal) const; // 0 if the goal is unreachable
+
+	// fit the weights (least squares) to the expansions of the single-process rows of results_file whose instance name
+	// is instance_name; returns the number of rows used (0 if there are too few to fit), and the RMS error in log2 units
+	int calibrate(const string& results_file, const string& instance_name, double& rms_error);
+	bool load(const string& model_file);
+	bool save(const string& model_file) const;
+
+private:
+	const Instance& instance;
+	vector< vector<int> > landmark_distances; // [landmark][loc] (MAX_COST if unreachable)
+	vector<int> component_sizes; // by component of the map index
+
+	void getInputs(const QueryFeatures& features, double* inputs) const;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "PreprocessedMap.h"
+
+
+// Long-running planner that keeps its maps and their preprocessing in memory and answers queries from a pool of
+// worker threads. Queries are read from stdin (answered on stdout) or from the connections of a Unix domain socket
+// (answered on the same connection), and responses are sent as soon as they are ready, so they may be out of order.
+//
+// Every message is a frame: its size in bytes (uint32), then its payload. All integers are little endian.
+// Request: id (uint32), map (uint16, an index into maps), the length of the algorithm name (uint8) and the name
+// (empty for the default algorithm), then the row and column of the start and of the goal (int32 each).
+// Response: id (uint32) and status (int32). If the status is QUERY_SOLVED or QUERY_UNSOLVED, the cost of the path
+// (int32, -1 if there is none), #expanded and #generated nodes (uint64 each), runtime in seconds (double) and the path
+// (see appendBinaryPath) follow; if it is QUERY_INVALID, an error message follows.
+class QueryServer
+{
+public:
+	enum query_status_t { QUERY_SOLVED, QUERY_UNSOLVED, QUERY_INVALID };
+
+	QueryServer(const vector<PreprocessedMap*>& maps, const string& default_algo, int num_of_workers);
+
+	// "stdin" or the path of a Unix domain socket; returns at the end of stdin, or false if the socket fails
+	bool run(const string& address);
+
+private:
+	struct Connection
+	{
+		int input;
+		int output;
+		bool owned; // the descriptors are closed with the connection
+		std::mutex lock; // of output
+		Connection(int input, int output, bool owned): input(input), output(output), owned(owned) {}
+		~Connection();
+		void send(const string& payload);
+	};
+	struct Query
+	{
+		shared_ptr<Connection> connection;
+		uint32_t id;
+		int map;
+		string algo;
+		int start_row, start_col, goal_row, goal_col;
+	};
+
+	vector<PreprocessedMap*> maps;
+	string default_algo;
+	int num_of_workers;
+
+	std::mutex lock; // of queries and closed
+	std::condition_variable ready;
+	std::deque<Query> queries;
+	bool closed = false;
+
+	void read(const shared_ptr<Connection>& connection); // queue the queries of the connection until it ends
+	void work(); // answer the queued queries until the server is closed
+	string answer(const Query& query, vector< std::unique_ptr<SearchContext> >& contexts);
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "Instance.h"
+
+
+// Reverse Resumable A* (Silver 2005): an A* search from the goal towards the start of the forward search that is
+// resumed only until the location whose heuristic is requested gets expanded. Since the Manhattan distance is
+// consistent, the g-value of every expanded location is its exact distance to the goal.
+class RRAStar
+{
+public:
+	uint64_t num_expanded = 0;
+
+	RRAStar(const Instance& instance, int goal);
+
+	int getGoal() const { return goal_location; }
+	// exact distance from loc to the goal (MAX_COST if unreachable); start is the start of the forward search
+	int getDistance(int loc, int start);
+
+private:
+	const Instance& instance;
+	int goal_location;
+	int start_location = -1; // the open list is ordered by the Manhattan distance to this location
+
+	vector<int> g_vals;
+	vector<bool> closed;
+	// (f_val, -g_val, location) in a binary heap, so the open list can be reordered when the start changes
+	typedef tuple<int, int, int> entry_t;
+	vector<entry_t> open_list;
+
+	void setStart(int start);
+	void resume(int loc); // expand until loc is closed or the open list is empty
+};
+
+
+// keeps the reverse searches of the most recent goals so that later queries to the same goal can reuse them
+class RRAStarCache
+{
+public:
+	RRAStarCache(const Instance& instance, int capacity): instance(instance), capacity(capacity) {}
+
+	RRAStar* get(int goal);
+
+private:
+	const Instance& instance;
+	int capacity;
+	unordered_map<int, std::unique_ptr<RRAStar> > searches;
+	list<int> goals; // in the order they are inserted
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "SingleAgentSolver.h"
+
+
+// Sink of the statistics and paths of the trials. The files stay open for the whole run, lines are appended to
+// in-memory buffers, and a background thread writes the buffers once they are large (and at the end), so that the
+// trials do not wait for the disk. Paths are written either in the text format ("Trial <index>: (row,col)->...") or
+// in the binary format below.
+class ResultWriter
+{
+public:
+	// empty file names disable the corresponding output
+	ResultWriter(const Instance& instance, const string& resultsFile, const string& instanceName,
+		const string& pathsFile, bool binaryPaths);
+	~ResultWriter(); // writes everything that is buffered
+
+	// whether the results can be appended to resultsFile: it does not exist, is empty or has the current header
+	static bool hasCurrentColumns(const string& resultsFile);
+
+	void addResults(const SingleAgentSolver& solver);
+	void addResults(const string& line); // a line of SingleAgentSolver::getResults, e.g., from another process
+	void addPath(const SingleAgentSolver& solver);
+
+private:
+	const Instance& instance;
+	string instance_name;
+	bool binary_paths;
+	ofstream results_file;
+	ofstream paths_file;
+
+	std::mutex lock;
+	std::condition_variable ready;
+	string results_buffer;
+	string paths_buffer;
+	bool done = false;
+	std::thread writer;
+
+	void write(); // of the background thread
+	void append(string& buffer, const char* data, size_t size);
+};
+
+
+// Binary path file: PATH_FILE_MAGIC, #rows and #cols of the map (int32 each), then the trial index (int32) and the
+// binary path of each trial.
+#define PATH_FILE_MAGIC "PASTARPT"
+
+// Binary path: #locations (int32); if the path is not empty, the row and column of its first location (int32 each) and
+// one 2-bit move (Instance::direction_t) per step, four per byte, the first one in the low bits.
+// A path with a step that is not a move to an adjacent location has #locations negated and stores the row-major
+// index (int32) of every location instead.
+void appendBinaryPath(const Instance& instance, const Path& path, string& buffer);
+
+// rewrite a binary path file in the text format of ResultWriter::addPath
+bool convertPaths(const string& binaryFile, const string& textFile);
@@ -0,0 +1,90 @@
+#pragma once
+#include "Instance.h"
+
+
+// Per-query scratch memory of a search on one instance (node storage, closed state, open list and path buffer),
+// reused across queries. There is one node per location, and a node is only valid if it was generated in the current
+// generation, so reset() is O(1) and a warm context serves queries without heap allocations.
+// A node is 16 bytes: g-val, parent location, generation and position in the open list (CLOSED if it is not open).
+// Its h-val is only kept in its open list entry, and the caller recomputes it when it reopens a closed node.
+// Nodes are stored as an array of structures, or as one array per field if SEARCH_CONTEXT_SOA is defined.
+class SearchContext
+{
+public:
+	struct OpenEntry
+	{
+		int f_val;
+		int h_val;
+		int location;
+	};
+
+	Path path; // output buffer of the last query
+	uint64_t num_of_resets = 0;
+
+	explicit SearchContext(const Instance& instance);
+
+	void reset();
+	bool isGenerated(int location) const { return generationOf(location) == generation; }
+	bool isOpen(int location) const { return heapIndexOf(location) != CLOSED; }
+	int getGVal(int location) const { return gValOf(location); }
+	int getParent(int location) const { return parentOf(location); } // -1 for the start
+	size_t getNumOfGenerated() const { return num_of_generated; }
+
+	void generate(int location, int g_val, int h_val, int parent); // and insert it into the open list
+	void improve(int location, int g_val, int parent); // of an open node
+	void reopen(int location, int g_val, int h_val, int parent); // of a closed node
+
+	// open list: binary heap ordered by f-val, then h-val
+	bool openEmpty() const { return open.empty(); }
+	size_t openSize() const { return open.size(); }
+	const OpenEntry& openTop() const { return open.front(); }
+	OpenEntry pop();
+
+private:
+	static const int CLOSED = -1;
+	uint32_t generation = 1;
+	size_t num_of_generated = 0;
+	vector<OpenEntry> open;
+
+#ifdef SEARCH_CONTEXT_SOA
+	vector<int> g_vals;
+	vector<int> parents;
+	vector<uint32_t> generations;
+	vector<int> heap_indices;
+
+	int& gValOf(int location) { return g_vals[location]; }
+	int& parentOf(int location) { return parents[location]; }
+	uint32_t& generationOf(int location) { return generations[location]; }
+	int& heapIndexOf(int location) { return heap_indices[location]; }
+	int gValOf(int location) const { return g_vals[location]; }
+	int parentOf(int location) const { return parents[location]; }
+	uint32_t generationOf(int location) const { return generations[location]; }
+	int heapIndexOf(int location) const { return heap_indices[location]; }
+#else
+	struct Node
+	{
+		int g_val;
+		int parent;
+		uint32_t generation;
+		int heap_index;
+	};
+	vector<Node> nodes;
+
+	int& gValOf(int location) { return nodes[location].g_val; }
+	int& parentOf(int location) { return nodes[location].parent; }
+	uint32_t& generationOf(int location) { return nodes[location].generation; }
+	int& heapIndexOf(int location) { return nodes[location].heap_index; }
+	int gValOf(int location) const { return nodes[location].g_val; }
+	int parentOf(int location) const { return nodes[location].parent; }
+	uint32_t generationOf(int location) const { return nodes[location].generation; }
+	int heapIndexOf(int location) const { return nodes[location].heap_index; }
+#endif
+
+	static bool better(const OpenEntry& e1, const OpenEntry& e2)
+	{
+		return e1.f_val < e2.f_val || (e1.f_val == e2.f_val && e1.h_val < e2.h_val);
+	}
+	void push(const OpenEntry& entry);
+	void siftUp(size_t index);
+	void siftDown(size_t index);
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "Instance.h"
+#include "mpi.h"
+
+
+// The exact heuristic table of one goal at a time, shared by the ranks of each node of an MPI communicator: the first
+// rank of the node computes it into an MPI shared-memory window, which the other ranks of the node read in place.
+// The constructor, get and the destructor are collective over the communicator.
+class SharedGoalDistances
+{
+public:
+	SharedGoalDistances(const Instance& instance, MPI_Comm comm);
+	~SharedGoalDistances();
+
+	// distances[loc] = distance from loc to goal (MAX_COST if it is unreachable); the table stays valid until get is
+	// called with another goal
+	shared_ptr<const int> get(int goal);
+
+private:
+	const Instance& instance;
+	MPI_Comm node_comm;
+	int node_rank;
+	MPI_Win window = MPI_WIN_NULL;
+	int goal = -1;
+	const int* table = nullptr;
+};
+
+
+// One copy of an instance per node for the ranks of an MPI communicator: the first rank of each node loads the files
+// into an MPI shared-memory window (MPI_Win_allocate_shared), and the other ranks of the node use the window in place,
+// read-only, instead of parsing the files themselves. The exact heuristic table of a goal is shared the same way.
+// The constructor, getGoalDistances and the destructor are collective over the communicator.
+class SharedInstance
+{
+public:
+	int num_of_node_ranks = 1; // ranks that share the window of this rank
+	size_t shared_size = 0; // bytes of the instance in the window
+	double loading_time = 0; // until every rank of the node can use the instance
+
+	SharedInstance(MPI_Comm comm, const string& map_fname, const string& agent_fname, int num_of_agents, int tile_size);
+	~SharedInstance();
+
+	const Instance& get() const { return *instance; }
+	// the table of SharedGoalDistances, computed by the first rank of the node
+	shared_ptr<const int> getGoalDistances(int goal) { return goal_distances->get(goal); }
+
+private:
+	MPI_Comm node_comm;
+	int node_rank;
+	MPI_Win instance_window = MPI_WIN_NULL;
+	std::unique_ptr<Instance> instance;
+	std::unique_ptr<SharedGoalDistances> goal_distances;
+};
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Instance.h"
+#include "RRAStar.h"
 
 class LLNode // low-level node
 {
@@ -57,8 +58,14 @@ public:
 	int start_location;
 	int goal_location;
 	vector<int> my_heuristic;  // this is the precomputed heuristic for this agent
+	RRAStar* reverse_search = nullptr; // if set, provides exact distances to its goal on demand
+	shared_ptr<const int> goal_distances; // if set, the exact distances of all locations to goal_location
 	int compute_heuristic(int from, int to) const  // compute admissible heuristic between two locations
 	{
+		if (goal_distances != nullptr && to == goal_location)
+			return goal_distances.get()[from];
+		if (reverse_search != nullptr && to == reverse_search->getGoal())
+			return reverse_search->getDistance(from, start_location);
 		return instance.getManhattanDistance(from, to);
 	}
 	const Instance& instance;
@@ -84,26 +91,36 @@ public:
 	int nproc = 1;
 	uint64_t num_expanded = 0;
 	uint64_t num_generated = 0;
+	uint64_t num_allocated = 0; // number of search nodes allocated
+	uint64_t peak_open_size = 0;
 	Path planned_path;
 	int path_cost;
 
-	void saveResults(const string &fileName, const string &instanceName) const;
-	void savePaths(const string &fileName) const;
+	static const char* results_header; // of the CSV files of ResultWriter
+	string getResults(const string &instanceName) const; // a line of the CSV files of ResultWriter
 
 
 	SingleAgentSolver(const Instance& instance, int trial) :
-		instance(instance), //agent(agent), 
-		start_location(instance.start_locations[trial]),
-		goal_location(instance.goal_locations[trial]),
-		trial_idx(trial)
+		trial_idx(trial), //agent(agent), 
+		start_location(trial >= 0 && trial < (int)instance.start_locations.size() ? instance.start_locations[trial] : -1),
+		goal_location(trial >= 0 && trial < (int)instance.goal_locations.size() ? instance.goal_locations[trial] : -1),
+		instance(instance)
 	{
 		// compute_heuristics();
 	}
 
+	// search between two given locations instead of the start and goal of the trial
+	SingleAgentSolver(const Instance& instance, int trial, int start, int goal) :
+		trial_idx(trial),
+		start_location(start),
+		goal_location(goal),
+		instance(instance) {}
+
     virtual ~SingleAgentSolver() =default;
 
 protected:
 	int min_f_val; // minimal f value in OPEN
+	MapIndex::Corridor corridor; // of the start and goal; locations outside it are dead ends
 	// int lower_bound; // Threshold for FOCAL
 	
 
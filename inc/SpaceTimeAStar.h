@@ -1,5 +1,9 @@
 ﻿#pragma once
+#include <atomic>
 #include "SingleAgentSolver.h"
+#include "SearchContext.h"
+
+class BoundingBoxes;
 
 
 class AStarNode: public LLNode
@@ -45,6 +49,10 @@ public:
 };
 
 
+// result of a slice of a resumable search
+enum class SearchStatus { IN_PROGRESS, FOUND, FAILED, CANCELLED };
+
+
 class SpaceTimeAStar: public SingleAgentSolver
 {
 public:
@@ -57,22 +65,42 @@ public:
 
 	string getName() const { return "AStar"; }
 
-	SpaceTimeAStar(const Instance& instance, int agent):
-		SingleAgentSolver(instance, agent) {}
+	// Resumable search for callers with a latency budget. OPEN and CLOSED persist between steps.
+	// step expands at most max_expansions nodes and returns after about max_seconds (if positive);
+	// the first step starts the search. Once it returns FOUND, the path is getPath().
+	SearchStatus step(uint64_t max_expansions, double max_seconds = 0);
+	void cancel() { cancelled = true; } // may be called from another thread; takes effect at the next expansion
+	SearchStatus getStatus() const { return status; }
+	int getMinFVal() const;
+	uint64_t getNumOfExpansions() const { return num_expanded; }
+	const Path& getPath() const { return context->path; } // valid until the context is used by another query
+
+	// Weight of the heuristic (weighted A*): with suboptimality > 1, paths cost at most suboptimality times the optimum,
+	// usually with far fewer expansions, and getMinFVal is no longer a lower bound.
+	double suboptimality = 1;
+
+	// The search state lives in context, which can be shared by consecutive searches on the same instance
+	// (without one, the solver allocates its own when the search starts).
+	SpaceTimeAStar(const Instance& instance, int agent, SearchContext* context = nullptr):
+		SingleAgentSolver(instance, agent), context(context) {}
+	SpaceTimeAStar(const Instance& instance, int agent, int start, int goal, SearchContext* context = nullptr):
+		SingleAgentSolver(instance, agent, start, goal), context(context) {}
+
+protected:
+	const BoundingBoxes* bounding_boxes = nullptr; // if set, only the moves towards the goal are generated
 
 private:
-	// define typedefs and handles for heap
-	typedef pairing_heap< AStarNode*, compare<AStarNode::compare_node> > heap_open_t;
-	heap_open_t open_list;
-
-	// define typedef for hash_map
-	typedef unordered_set<AStarNode*, AStarNode::NodeHasher, AStarNode::eqnode> hashtable_t;
-	hashtable_t allNodes_table;
-
-	// Updates the path datamember
-	void updatePath(const LLNode* goal, vector<PathEntry> &path);
-	inline AStarNode* popNode();
-	inline void pushNode(AStarNode* node);
-	void releaseNodes();
-
+	SearchContext* context;
+	std::unique_ptr<SearchContext> own_context;
+	bool started = false;
+	SearchStatus status = SearchStatus::IN_PROGRESS;
+	std::atomic<bool> cancelled{false};
+
+	void start();
+	void finish(SearchStatus result);
+	void updatePath(int goal);
+	int weigh(int h_val) const
+	{
+		return suboptimality > 1 && h_val < MAX_COST ? (int)(h_val * suboptimality) : h_val;
+	}
 };
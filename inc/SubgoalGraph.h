@@ -0,0 +1,55 @@
+#pragma once
+#include "SingleAgentSolver.h"
+
+
+// Simple subgoal graph: subgoals are the free cells at the corners of obstacles, and two subgoals are
+// connected iff they are direct-h-reachable, i.e., there is a path of Manhattan length between them that
+// does not pass through any other subgoal. Any shortest path can be decomposed into such segments.
+class SubgoalGraph
+{
+public:
+	vector<int> subgoals; // location of each subgoal
+	vector<int> subgoal_id; // subgoal id of each location (-1 if it is not a subgoal)
+	vector< vector< pair<int, int> > > edges; // (neighbor subgoal id, cost) of each subgoal
+	int num_of_edges = 0;
+	double preprocessing_time = 0;
+
+	SubgoalGraph(const Instance& instance);
+
+	int getNumOfSubgoals() const { return (int)subgoals.size(); }
+	bool isSubgoal(int loc) const { return subgoal_id[loc] >= 0; }
+
+	// collect (location, cost) of the subgoals that are direct-h-reachable from loc;
+	// target (if >= 0) is treated as an additional subgoal
+	void getDirectHReachable(int loc, vector< pair<int, int> >& reachable, int target = -1) const;
+
+private:
+	const Instance& instance;
+
+	bool isCorner(int loc) const;
+	bool isFree(int row, int col) const
+	{
+		return row >= 0 && row < instance.num_of_rows && col >= 0 && col < instance.num_of_cols &&
+			!instance.isObstacle(instance.linearizeCoordinate(row, col));
+	}
+};
+
+
+class SubgoalGraphSearch: public SingleAgentSolver
+{
+public:
+	// connect start and goal to the subgoal graph, search the subgoal graph and refine the abstract path
+	Path findOptimalPath();
+	Path findSuboptimalPath();  // return the path and the lowerbound
+
+	string getName() const { return "SUB"; }
+
+	SubgoalGraphSearch(const Instance& instance, int agent, const SubgoalGraph& graph):
+		SingleAgentSolver(instance, agent), graph(graph) {}
+
+private:
+	const SubgoalGraph& graph;
+
+	// Updates the path datamember
+	void updatePath(const vector<int>& abstract_path, vector<PathEntry> &path) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "PreprocessedMap.h"
+#include "ResultWriter.h"
+#include "SharedInstance.h"
+
+
+// Parameters of the task farm (see the options of the driver)
+struct FarmOptions
+{
+	int escalate_expansions = 100000; // A* gives a trial up to the HDA* group after this many expansions (0: never)
+	int escalate_distance = 0; // trials whose Manhattan distance is at least this go to the HDA* group directly (0: none)
+	int hda_ranks = -1; // size of the HDA* group (-1: one rank if there are at least three; 0: no escalation)
+	int screen = 1;
+};
+
+
+// Throughput mode of the MPI driver. Rank 0 hands out the trials one at a time to the workers, which solve them with
+// sequential A* and ask for the next one as soon as they are done. A trial on which A* reaches the expansion limit, or
+// whose Manhattan distance predicts a hard search, is queued for the HDA* group (the last ranks), which solves the hard
+// trials one at a time on its own communicator. The results of all trials are written by rank 0 in trial order.
+// With the BFS heuristic, the ranks of the HDA* group on a node share the heuristic table of the current trial.
+class TaskFarm
+{
+public:
+	int num_of_workers = 0; // ranks that run A*
+	int num_of_hda_ranks = 0;
+	int num_of_escalations = 0; // on rank 0: trials solved by the HDA* group
+	int num_of_predictions = 0; // on rank 0: trials sent to the HDA* group without trying A*
+
+	// map is built on the instance of shared_instance; instance_name is the name of the instance in the results
+	TaskFarm(PreprocessedMap& map, SharedInstance& shared_instance, const FarmOptions& options,
+		const string& instance_name);
+	~TaskFarm();
+
+	// solve trials [0, num_of_trials); writer is only used on rank 0. Collective over MPI_COMM_WORLD; returns false (on
+	// every rank) if there are too few ranks for a worker.
+	bool run(int num_of_trials, ResultWriter* writer);
+
+private:
+	PreprocessedMap& map;
+	const FarmOptions options;
+	string instance_name;
+	int pid;
+	int nproc;
+	MPI_Comm hda_comm = MPI_COMM_NULL; // of the HDA* group, whose first rank talks to rank 0
+	std::unique_ptr<SharedGoalDistances> hda_distances; // on the ranks of the HDA* group, with the BFS heuristic
+
+	void schedule(int num_of_trials, ResultWriter* writer); // of rank 0
+	void work(); // of the workers and of the first rank of the HDA* group
+	string solveWithAStar(int trial, SearchContext& context, bool& escalated);
+	string solveWithHDAStar(int trial);
+	bool isPredictedHard(int trial) const;
+};
@@ -57,6 +57,9 @@ private:
   std::chrono::time_point<clock_> beg_;
 };
 
+// peak resident set size of the process in KB
+size_t getPeakMemoryUsage();
+
 struct PathEntry
 {
 	int location = -1;
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+// API of libpastar, the planner as a library. It only depends on the standard library, and the solvers and their
+// preprocessing stay behind it, so programs that embed the planner only include this header.
+namespace pastar
+{
+
+struct Options
+{
+	std::string algorithm = "A*"; // A*, wA*, EPEA*, MM, BFHS, ExternalA*, MQA*, GA*, PBNF, SUB, HPA*, BB or auto
+	std::string heuristic = "Manhattan"; // Manhattan or BFS (EPEA* only supports Manhattan)
+	int num_of_threads = 1; // of the preprocessing and of the parallel algorithms
+	int cluster_size = 16; // of HPA*
+	int heuristic_memory_mb = 256; // of the BFS heuristic tables
+	std::string heuristic_dir; // where the BFS heuristic tables are saved and memory-mapped (none if empty)
+	int tile_size = 1; // side of the tiles in which locations are numbered (a power of two)
+	double suboptimality = 1; // of wA*, and of auto on the queries that are not easy (their paths may be longer)
+	std::string predictor_model; // weights of the query predictor of auto (see the --calibrate option of the driver)
+};
+
+struct Cell
+{
+	int32_t row;
+	int32_t col;
+};
+
+struct Query
+{
+	Cell start;
+	Cell goal;
+};
+
+enum Status { SOLVED, UNSOLVED, INVALID_QUERY, PATH_BUFFER_TOO_SMALL };
+
+struct Result
+{
+	Status status = INVALID_QUERY;
+	int cost = -1; // -1 if there is no path
+	int path_length = 0; // #cells of the path (the path is only written if they fit in the buffer)
+	uint64_t num_expanded = 0;
+	uint64_t num_generated = 0;
+	double runtime = 0; // seconds
+};
+
+// A map with the preprocessing of its algorithms, built when the planner is created (for options.algorithm) or the
+// first time another algorithm is used. The search memory is kept between queries, so repeated queries do not
+// allocate it again. A planner is not thread-safe, except for the workers of solveBatch.
+class Planner
+{
+public:
+	// load a map file (text or binary); nullptr if it cannot be read, is not a map, the options are invalid or the
+	// preprocessing of options.algorithm cannot be built for it (BB on maps of more than 65535 rows or columns)
+	static std::unique_ptr<Planner> load(const std::string& map_file, const Options& options = Options());
+	// a map of num_of_rows x num_of_cols cells given row by row (cell i is an obstacle iff obstacles[i] != 0); nullptr
+	// in the same cases as load
+	static std::unique_ptr<Planner> create(int num_of_rows, int num_of_cols, const uint8_t* obstacles,
+		const Options& options = Options());
+	~Planner();
+
+	int getNumOfRows() const;
+	int getNumOfCols() const;
+
+	// solve query with algorithm (options.algorithm if empty) and write its path to path[0..capacity)
+	Result solve(const Query& query, Cell* path, int capacity, const std::string& algorithm = "");
+	// solve queries[0..num_of_queries) with num_of_threads threads; the path of query i is written to
+	// paths[i * capacity..(i + 1) * capacity) and its result to results[i]
+	void solveBatch(const Query* queries, int num_of_queries, Cell* paths, int capacity, Result* results,
+		int num_of_threads = 1, const std::string& algorithm = "");
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+
+	explicit Planner(std::unique_ptr<Impl> impl);
+};
+
+}
@@ -0,0 +1,159 @@
+#include "BFHS.h"
+
+// approximate size of a stored node (an entry of an unordered_map<int, int>)
+#define NODE_BYTES 32
+
+
+Path BFHS::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path BFHS::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 0;
+	num_allocated = 0;
+	peak_open_size = 0;
+	num_of_relays = 0;
+	out_of_memory = false;
+
+	vector<int> locations;
+	if (solve(start_location, goal_location, locations))
+	{
+		path.reserve(locations.size() + 1);
+		path.emplace_back(start_location);
+		for (int loc : locations)
+			path.emplace_back(loc);
+	}
+	else if (out_of_memory)
+	{
+		cerr << "BFHS runs out of memory on trial " << trial_idx << endl;
+	}
+
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+// iterate on the upper bound, growing its gap to the heuristic geometrically, until the goal is found
+bool BFHS::solve(int start, int goal, vector<int>& path)
+{
+	int initial_bound = compute_heuristic(start, goal);
+	int upper_bound = initial_bound;
+	while (true)
+	{
+		int next_bound = MAX_COST, relay = -1;
+		search_result result = search(start, goal, upper_bound, next_bound, relay, path);
+		layers.clear();
+		switch (result)
+		{
+		case FOUND:
+			return true;
+		case FOUND_RELAY:
+			num_of_relays++;
+			return solve(start, relay, path) && solve(relay, goal, path);
+		case OUT_OF_MEMORY:
+			out_of_memory = true;
+			return false;
+		case NOT_FOUND:
+			if (next_bound == MAX_COST) // nothing was pruned, so the goal is unreachable
+				return false;
+			upper_bound = max(next_bound, upper_bound + (upper_bound - initial_bound));
+			break;
+		}
+	}
+}
+
+
+BFHS::search_result BFHS::search(int start, int goal, int upper_bound, int& next_bound, int& relay, vector<int>& path)
+{
+	bool has_relay = false;
+	layers.emplace_back();
+	layers.back()[start] = -1;
+	num_allocated++;
+	for (int depth = 0; ; depth++)
+	{
+		const auto& curr = layers.back();
+		if (curr.empty())
+			return NOT_FOUND;
+		auto goal_it = curr.find(goal);
+		if (goal_it != curr.end())
+		{
+			if (has_relay)
+			{
+				relay = goal_it->second;
+				return FOUND_RELAY;
+			}
+			// all layers are kept, so walk back through them
+			size_t offset = path.size();
+			int loc = goal;
+			for (int d = depth; d > 0; d--)
+			{
+				path.push_back(loc);
+				const auto& prev = layers[d - 1];
+				for (int next : instance.getNeighbors(loc))
+				{
+					if (prev.count(next))
+					{
+						loc = next;
+						break;
+					}
+				}
+			}
+			std::reverse(path.begin() + offset, path.end());
+			return FOUND;
+		}
+
+		// generate the next layer (in an undirected graph, duplicates can only be in the previous,
+		// the current and the next layers)
+		const unordered_map<int, int>* prev = layers.size() > 1 ? &layers[layers.size() - 2] : nullptr;
+		unordered_map<int, int> next_layer;
+		for (const auto& entry : curr)
+		{
+			num_expanded++;
+			for (int next : instance.getNeighbors(entry.first))
+			{
+				int next_f_val = depth + 1 + compute_heuristic(next, goal);
+				if (next_f_val > upper_bound)
+				{
+					next_bound = min(next_bound, next_f_val);
+					continue;
+				}
+				if (curr.count(next) || (prev != nullptr && prev->count(next)) || next_layer.count(next))
+					continue;
+				next_layer[next] = entry.second;
+				num_generated++;
+			}
+		}
+		num_allocated += next_layer.size();
+		peak_open_size = max(peak_open_size, (uint64_t)next_layer.size());
+		layers.push_back(std::move(next_layer));
+
+		if (getMemoryUsage() <= max_memory || layers.back().count(goal))
+			continue;
+		if (!has_relay)
+		{
+			// the newest layer becomes the relay layer
+			has_relay = true;
+			for (auto& entry : layers.back())
+				entry.second = entry.first;
+		}
+		while (layers.size() > 2)
+			layers.pop_front();
+		if (getMemoryUsage() > max_memory)
+			return OUT_OF_MEMORY;
+	}
+}
+
+
+uint64_t BFHS::getMemoryUsage() const
+{
+	uint64_t num_of_nodes = 0;
+	for (const auto& layer : layers)
+		num_of_nodes += layer.size();
+	return num_of_nodes * NODE_BYTES;
+}
@@ -0,0 +1,128 @@
+#include "BidirectionalAStar.h"
+
+
+Path BidirectionalAStar::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path BidirectionalAStar::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 0;
+	num_expanded_forward = 0;
+	num_expanded_backward = 0;
+	best_cost = MAX_COST;
+	meeting_location = -1;
+	states.assign(instance.map_size, State());
+
+	pushNode(FORWARD, start_location, 0, -1);
+	pushNode(BACKWARD, goal_location, 0, -1);
+	if (start_location == goal_location)
+	{
+		best_cost = 0;
+		meeting_location = start_location;
+	}
+
+	while (true)
+	{
+		int pr_min[DIRECTION_COUNT];
+		for (int dir = 0; dir < DIRECTION_COUNT; dir++)
+			pr_min[dir] = getMinKey(dir, pr_queue[dir]);
+		int lower_bound = min(pr_min[FORWARD], pr_min[BACKWARD]);
+		if (lower_bound == MAX_COST) // one of the frontiers is exhausted
+			break;
+		lower_bound = max(lower_bound, getMinKey(FORWARD, f_queue[FORWARD]));
+		lower_bound = max(lower_bound, getMinKey(BACKWARD, f_queue[BACKWARD]));
+		lower_bound = max(lower_bound, getMinKey(FORWARD, g_queue[FORWARD]) + getMinKey(BACKWARD, g_queue[BACKWARD]) + 1);
+		if (best_cost <= lower_bound)
+			break;
+
+		// expand the direction with the smaller priority (forward on ties)
+		expandNode(pr_min[FORWARD] <= pr_min[BACKWARD] ? FORWARD : BACKWARD);
+	}
+
+	if (meeting_location >= 0)
+		updatePath(path);
+	states.clear();
+	for (int dir = 0; dir < DIRECTION_COUNT; dir++)
+	{
+		pr_queue[dir] = queue_t();
+		f_queue[dir] = queue_t();
+		g_queue[dir] = queue_t();
+	}
+
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+bool BidirectionalAStar::isStale(int dir, const entry_t& entry) const
+{
+	const State& state = states[get<2>(entry)];
+	return state.closed[dir] || state.g_val[dir] != -get<1>(entry);
+}
+
+
+int BidirectionalAStar::getMinKey(int dir, queue_t& queue) const
+{
+	while (!queue.empty() && isStale(dir, queue.top()))
+		queue.pop();
+	return queue.empty() ? MAX_COST : get<0>(queue.top());
+}
+
+
+void BidirectionalAStar::pushNode(int dir, int loc, int g_val, int parent)
+{
+	State& state = states[loc];
+	state.g_val[dir] = g_val;
+	state.parent[dir] = parent;
+	int f_val = g_val + compute_heuristic(loc, getTarget(dir));
+	pr_queue[dir].emplace(max(f_val, 2 * g_val), -g_val, loc);
+	f_queue[dir].emplace(f_val, -g_val, loc);
+	g_queue[dir].emplace(g_val, -g_val, loc);
+	num_generated++;
+}
+
+
+void BidirectionalAStar::expandNode(int dir)
+{
+	int curr = get<2>(pr_queue[dir].top()); // getMinKey has removed the stale entries
+	pr_queue[dir].pop();
+	State& state = states[curr];
+	state.closed[dir] = true;
+	num_expanded++;
+	if (dir == FORWARD)
+		num_expanded_forward++;
+	else
+		num_expanded_backward++;
+
+	int next_g_val = state.g_val[dir] + 1;
+	for (int next : instance.getNeighbors(curr))
+	{
+		State& next_state = states[next];
+		if (next_state.g_val[dir] <= next_g_val)
+			continue;
+		pushNode(dir, next, next_g_val, curr);
+		if (next_state.g_val[1 - dir] < MAX_COST && next_g_val + next_state.g_val[1 - dir] < best_cost)
+		{
+			best_cost = next_g_val + next_state.g_val[1 - dir];
+			meeting_location = next;
+		}
+	}
+}
+
+
+// join the forward path from start to the meeting location with the backward path from there to goal
+void BidirectionalAStar::updatePath(vector<PathEntry> &path) const
+{
+	path.reserve(best_cost + 1);
+	for (int curr = meeting_location; curr >= 0; curr = states[curr].parent[FORWARD])
+		path.emplace_back(curr);
+	std::reverse(path.begin(), path.end());
+	for (int curr = states[meeting_location].parent[BACKWARD]; curr >= 0; curr = states[curr].parent[BACKWARD])
+		path.emplace_back(curr);
+}
@@ -0,0 +1,162 @@
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BoundingBoxes.h"
+
+
+BoundingBoxes::BoundingBoxes(const Instance& instance, int num_of_threads): instance(instance)
+{
+	Timer timer;
+	if (instance.num_of_rows > UINT16_MAX || instance.num_of_cols > UINT16_MAX)
+	{
+		cerr << "Bounding boxes only support maps with at most " << UINT16_MAX << " rows and columns." << endl;
+		return;
+	}
+	storage.resize((size_t)instance.num_of_rows * instance.num_of_cols * Instance::DIRECTION_COUNT,
+		{UINT16_MAX, 0, UINT16_MAX, 0});
+	boxes = storage.data();
+
+	// sources are independent, so their searches run in parallel
+	std::atomic<int> next_source(0);
+	auto worker = [&]()
+	{
+		vector<uint32_t> visited(instance.map_size, 0);
+		vector<uint8_t> first_moves(instance.map_size);
+		vector<int> queue(instance.map_size);
+		uint32_t generation = 0;
+		for (int source = next_source++; source < instance.num_of_rows * instance.num_of_cols; source = next_source++)
+		{
+			int loc = instance.linearizeCoordinate(source / instance.num_of_cols, source % instance.num_of_cols);
+			if (!instance.isObstacle(loc))
+				search(loc, visited, ++generation, first_moves, queue);
+		}
+	};
+	vector<std::thread> threads;
+	for (int i = 1; i < num_of_threads; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+	preprocessing_time = timer.elapsed();
+}
+
+
+// BFS from source, where every location inherits the first move of its BFS parent
+void BoundingBoxes::search(int source, vector<uint32_t>& visited, uint32_t generation, vector<uint8_t>& first_moves,
+	vector<int>& queue)
+{
+	int source_row = instance.getRowCoordinate(source), source_col = instance.getColCoordinate(source);
+	bool inside[4] = {source_col < instance.num_of_cols - 1, source_col > 0, source_row < instance.num_of_rows - 1,
+		source_row > 0};
+	size_t head = 0, tail = 0;
+	visited[source] = generation;
+	for (int direction = 0; direction < Instance::DIRECTION_COUNT; direction++)
+	{
+		if (!inside[direction])
+			continue;
+		int next = instance.getAdjacent(source, direction);
+		if (instance.isObstacle(next))
+			continue;
+		visited[next] = generation;
+		first_moves[next] = direction;
+		queue[tail++] = next;
+	}
+	Box* source_boxes = &storage[((size_t)source_row * instance.num_of_cols + source_col) * Instance::DIRECTION_COUNT];
+	Box local[Instance::DIRECTION_COUNT];
+	memcpy(local, source_boxes, sizeof(local));
+	while (head < tail)
+	{
+		int curr = queue[head++];
+		uint16_t row = instance.getRowCoordinate(curr), col = instance.getColCoordinate(curr);
+		Box& box = local[first_moves[curr]];
+		box.min_row = min(box.min_row, row);
+		box.max_row = max(box.max_row, row);
+		box.min_col = min(box.min_col, col);
+		box.max_col = max(box.max_col, col);
+		int neighbors[4];
+		int num_of_neighbors = instance.getNeighbors(curr, neighbors);
+		for (int i = 0; i < num_of_neighbors; i++)
+		{
+			if (visited[neighbors[i]] == generation)
+				continue;
+			visited[neighbors[i]] = generation;
+			first_moves[neighbors[i]] = first_moves[curr];
+			queue[tail++] = neighbors[i];
+		}
+	}
+	memcpy(source_boxes, local, sizeof(local));
+}
+
+
+int BoundingBoxes::getSuccessors(int curr, int goal, int neighbors[4], int h_vals[4]) const
+{
+	int row = instance.getRowCoordinate(curr), col = instance.getColCoordinate(curr);
+	int goal_row = instance.getRowCoordinate(goal), goal_col = instance.getColCoordinate(goal);
+	const Box* curr_boxes = &boxes[((size_t)row * instance.num_of_cols + col) * Instance::DIRECTION_COUNT];
+	// a non-empty box implies that the move stays on the map and does not hit an obstacle
+	int rows[4] = {row, row, row + 1, row - 1};
+	int cols[4] = {col + 1, col - 1, col, col};
+	int num_of_neighbors = 0;
+	for (int direction = 0; direction < Instance::DIRECTION_COUNT; direction++)
+	{
+		const Box& box = curr_boxes[direction];
+		if (box.min_row <= goal_row && goal_row <= box.max_row && box.min_col <= goal_col && goal_col <= box.max_col)
+		{
+			neighbors[num_of_neighbors] = instance.getAdjacent(curr, direction);
+			h_vals[num_of_neighbors++] = abs(rows[direction] - goal_row) + abs(cols[direction] - goal_col);
+		}
+	}
+	return num_of_neighbors;
+}
+
+
+bool BoundingBoxes::save(const string& fileName) const
+{
+	ofstream output(fileName, std::ios::binary);
+	if (!output.is_open())
+		return false;
+	char header[BOUNDING_BOXES_HEADER_SIZE] = {};
+	int32_t dims[2] = {instance.num_of_rows, instance.num_of_cols};
+	memcpy(header, BOUNDING_BOXES_MAGIC, 8);
+	uint64_t map_hash = instance.getMapHash();
+	memcpy(header + 8, dims, sizeof(dims));
+	memcpy(header + 16, &map_hash, sizeof(map_hash));
+	output.write(header, BOUNDING_BOXES_HEADER_SIZE);
+	output.write(reinterpret_cast<const char*>(boxes),
+		(size_t)instance.num_of_rows * instance.num_of_cols * Instance::DIRECTION_COUNT * sizeof(Box));
+	return output.good();
+}
+
+
+BoundingBoxes::BoundingBoxes(const Instance& instance, const string& fileName): instance(instance)
+{
+	Timer timer;
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	char header[BOUNDING_BOXES_HEADER_SIZE];
+	int32_t dims[2];
+	uint64_t map_hash;
+	struct stat st;
+	size_t length = BOUNDING_BOXES_HEADER_SIZE +
+		(size_t)instance.num_of_rows * instance.num_of_cols * Instance::DIRECTION_COUNT * sizeof(Box);
+	bool valid = read(fd, header, BOUNDING_BOXES_HEADER_SIZE) == BOUNDING_BOXES_HEADER_SIZE &&
+		memcmp(header, BOUNDING_BOXES_MAGIC, 8) == 0 && fstat(fd, &st) == 0 && (size_t)st.st_size >= length;
+	if (valid)
+	{
+		memcpy(dims, header + 8, sizeof(dims));
+		memcpy(&map_hash, header + 16, sizeof(map_hash));
+		valid = dims[0] == instance.num_of_rows && dims[1] == instance.num_of_cols && map_hash == instance.getMapHash();
+	}
+	void* addr = valid ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (addr == MAP_FAILED)
+		return;
+	mapping = shared_ptr<const void>(addr, [length](const void* p) { munmap(const_cast<void*>(p), length); });
+	boxes = reinterpret_cast<const Box*>(static_cast<const char*>(addr) + BOUNDING_BOXES_HEADER_SIZE);
+	preprocessing_time = timer.elapsed();
+}
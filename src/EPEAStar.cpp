@@ -0,0 +1,182 @@
+#include "EPEAStar.h"
+
+
+OperatorTable::OperatorTable(const Instance& instance): instance(instance)
+{
+	move_directions[NORTH] = Instance::UP;
+	move_directions[EAST] = Instance::RIGHT;
+	move_directions[SOUTH] = Instance::DOWN;
+	move_directions[WEST] = Instance::LEFT;
+
+	valid_moves.resize(instance.map_size, 0);
+	for (int loc = 0; loc < instance.map_size; loc++)
+	{
+		if (instance.isObstacle(loc))
+			continue;
+		int row = instance.getRowCoordinate(loc);
+		int col = instance.getColCoordinate(loc);
+		if (row > 0 && !instance.isObstacle(getNextLocation(loc, NORTH)))
+			valid_moves[loc] |= 1 << NORTH;
+		if (col < instance.num_of_cols - 1 && !instance.isObstacle(getNextLocation(loc, EAST)))
+			valid_moves[loc] |= 1 << EAST;
+		if (row < instance.num_of_rows - 1 && !instance.isObstacle(getNextLocation(loc, SOUTH)))
+			valid_moves[loc] |= 1 << SOUTH;
+		if (col > 0 && !instance.isObstacle(getNextLocation(loc, WEST)))
+			valid_moves[loc] |= 1 << WEST;
+	}
+
+	// moves towards the goal keep f unchanged (delta index 0), the other moves increase f by 2 (delta index 1)
+	for (int valid = 0; valid < (1 << MOVE_COUNT); valid++)
+	{
+		for (int toward = 0; toward < (1 << MOVE_COUNT); toward++)
+		{
+			for (int move = 0; move < MOVE_COUNT; move++)
+			{
+				if (!(valid & (1 << move)))
+					continue;
+				Operators& ops = operators[valid][toward][(toward & (1 << move)) ? 0 : 1];
+				ops.moves[ops.num_of_moves++] = move;
+			}
+		}
+	}
+}
+
+
+unsigned char OperatorTable::getTowardMoves(int loc, int goal) const
+{
+	int row = instance.getRowCoordinate(loc), goal_row = instance.getRowCoordinate(goal);
+	int col = instance.getColCoordinate(loc), goal_col = instance.getColCoordinate(goal);
+	unsigned char toward = 0;
+	if (goal_row < row)
+		toward |= 1 << NORTH;
+	else if (goal_row > row)
+		toward |= 1 << SOUTH;
+	if (goal_col < col)
+		toward |= 1 << WEST;
+	else if (goal_col > col)
+		toward |= 1 << EAST;
+	return toward;
+}
+
+
+void EPEAStar::updatePath(const LLNode* goal, vector<PathEntry> &path)
+{
+	const LLNode* curr = goal;
+	path.reserve(curr->g_val + 1);
+	while (curr != nullptr)
+	{
+		path.emplace_back(curr->location);
+		curr = curr->parent;
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+
+Path EPEAStar::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path EPEAStar::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 0;
+	num_allocated = 1;
+	peak_open_size = 0;
+
+	auto start = new EPEANode(start_location, 0, instance.getManhattanDistance(start_location, goal_location), nullptr, 0);
+	pushNode(start);
+	allNodes_table[start_location] = start;
+
+	while (!open_list.empty())
+	{
+		auto* curr = popNode();
+		if (curr->location == goal_location)
+		{
+			updatePath(curr, path);
+			break;
+		}
+
+		unsigned char toward_moves = operators.getTowardMoves(curr->location, goal_location);
+		int delta_index = (curr->stored_f_val - curr->getFVal()) / 2;
+		const auto& ops = operators.getOperators(curr->location, toward_moves, delta_index);
+		for (int i = 0; i < ops.num_of_moves; i++)
+		{
+			int next_location = operators.getNextLocation(curr->location, ops.moves[i]);
+			int next_g_val = curr->g_val + 1;
+			auto it = allNodes_table.find(next_location);
+			if (it == allNodes_table.end())
+			{
+				int next_h_val = curr->h_val + (delta_index == 0 ? -1 : 1);
+				auto next = new EPEANode(next_location, next_g_val, next_h_val, curr, curr->timestep + 1);
+				num_allocated++;
+				pushNode(next);
+				allNodes_table[next_location] = next;
+				continue;
+			}
+
+			// update existing node if its g-val decreased through this new path
+			auto existing_next = it->second;
+			if (existing_next->g_val <= next_g_val)
+				continue;
+			existing_next->g_val = next_g_val;
+			existing_next->parent = curr;
+			existing_next->timestep = curr->timestep + 1;
+			existing_next->stored_f_val = existing_next->getFVal();
+			if (existing_next->in_openlist)
+				open_list.increase(existing_next->open_handle);  // increase because F improved
+			else
+				pushNode(existing_next); // reopen
+		}
+
+		// put the node back with the next F if one of its remaining successors can still be improved through it
+		if (delta_index == 0)
+		{
+			const auto& next_ops = operators.getOperators(curr->location, toward_moves, 1);
+			for (int i = 0; i < next_ops.num_of_moves; i++)
+			{
+				auto it = allNodes_table.find(operators.getNextLocation(curr->location, next_ops.moves[i]));
+				if (it == allNodes_table.end() || it->second->g_val > curr->g_val + 1)
+				{
+					curr->stored_f_val = curr->getFVal() + 2;
+					pushNode(curr);
+					break;
+				}
+			}
+		}
+	}
+
+	releaseNodes();
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+inline EPEANode* EPEAStar::popNode()
+{
+	auto node = open_list.top(); open_list.pop();
+	node->in_openlist = false;
+	num_expanded++;
+	return node;
+}
+
+
+inline void EPEAStar::pushNode(EPEANode* node)
+{
+	node->open_handle = open_list.push(node);
+	node->in_openlist = true;
+	num_generated++;
+	peak_open_size = max(peak_open_size, (uint64_t)open_list.size());
+}
+
+
+void EPEAStar::releaseNodes()
+{
+	open_list.clear();
+	for (auto entry: allNodes_table)
+		delete entry.second;
+	allNodes_table.clear();
+}
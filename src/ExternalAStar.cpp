@@ -0,0 +1,451 @@
+#include <cstdlib>
+#include <queue>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ExternalAStar.h"
+
+// largest block of a bucket stream (in records)
+#define MAX_BLOCK_RECORDS (1 << 17)
+#define MIN_BLOCK_RECORDS 1024
+// segment files are appended to until they reach this size
+#define MAX_SEGMENT_BYTES ((uint64_t)1 << 30)
+
+
+BucketReader::BucketReader(const ExternalBucket* bucket, size_t block_records): bucket(bucket)
+{
+	if (bucket != nullptr && !bucket->extents.empty())
+	{
+		block_records = min(block_records, (size_t)(bucket->size - bucket->buffer.size()));
+		block.reserve(block_records);
+		next_block.reserve(block_records);
+		readBlock(block);
+		if (extent_index < bucket->extents.size())
+			prefetch = std::async(std::launch::async, &BucketReader::readBlock, this, std::ref(next_block));
+	}
+	if (block.empty())
+		nextBlock();
+}
+
+
+BucketReader::~BucketReader()
+{
+	if (prefetch.valid())
+		prefetch.wait();
+}
+
+
+void BucketReader::pop()
+{
+	if (++pos >= block.size())
+		nextBlock();
+}
+
+
+void BucketReader::nextBlock()
+{
+	pos = 0;
+	if (prefetch.valid())
+	{
+		prefetch.get();
+		std::swap(block, next_block);
+		if (extent_index < bucket->extents.size())
+			prefetch = std::async(std::launch::async, &BucketReader::readBlock, this, std::ref(next_block));
+		if (!block.empty())
+			return;
+	}
+	if (bucket != nullptr) // the extents have ended, so continue with the buffer
+	{
+		block = bucket->buffer;
+		bucket = nullptr;
+	}
+	else
+	{
+		block.clear();
+	}
+}
+
+
+// fill the buffer from the next extents (small extents are read into one block)
+void BucketReader::readBlock(vector<ExternalRecord>& buffer)
+{
+	buffer.resize(buffer.capacity());
+	size_t num_of_records = 0;
+	while (num_of_records < buffer.size() && extent_index < bucket->extents.size())
+	{
+		const ExternalExtent& extent = bucket->extents[extent_index];
+		size_t n = min((uint64_t)(buffer.size() - num_of_records), extent.num_of_records - extent_pos);
+		char* data = reinterpret_cast<char*>(buffer.data() + num_of_records);
+		size_t length = n * sizeof(ExternalRecord), done = 0;
+		off_t offset = (extent.offset + extent_pos) * sizeof(ExternalRecord);
+		while (done < length)
+		{
+			ssize_t bytes = pread(extent.fd, data + done, length - done, offset + done);
+			if (bytes <= 0)
+			{
+				cerr << "Fail to read a bucket" << endl;
+				exit(-1);
+			}
+			done += bytes;
+		}
+		num_of_records += n;
+		extent_pos += n;
+		if (extent_pos == extent.num_of_records)
+		{
+			extent_index++;
+			extent_pos = 0;
+		}
+	}
+	buffer.resize(num_of_records);
+}
+
+
+Path ExternalAStar::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path ExternalAStar::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 1;
+	num_allocated = 0;
+	peak_open_size = 0;
+	num_of_buckets = 0;
+	bytes_written = 0;
+
+	string pattern = root_directory + "/pastar-XXXXXX";
+	vector<char> name(pattern.begin(), pattern.end());
+	name.push_back('\0');
+	if (mkdtemp(name.data()) == nullptr)
+	{
+		cerr << "Fail to create a temporary directory in " << root_directory << endl;
+		exit(-1);
+	}
+	directory = name.data();
+
+	int start_h_val = compute_heuristic(start_location, goal_location);
+	push(open_buckets[make_pair(start_h_val, 0)], {start_location, -1});
+	open_size = 1;
+
+	while (!open_buckets.empty())
+	{
+		int g_val = open_buckets.begin()->first.second;
+		int h_val = open_buckets.begin()->first.first - g_val;
+		ExternalBucket bucket = std::move(open_buckets.begin()->second);
+		open_buckets.erase(open_buckets.begin());
+		open_size -= bucket.size;
+		ExternalRecord goal;
+		if (expandBucket(g_val, h_val, bucket, goal))
+		{
+			path.resize(g_val + 1);
+			path[g_val] = goal.location;
+			for (int g = g_val - 1; g >= 0; g--)
+			{
+				path[g] = goal.parent;
+				if (!findRecord(goal.parent, g, goal))
+				{
+					cerr << "ExternalA* cannot find the parent of a node on the path" << endl;
+					exit(-1);
+				}
+			}
+			break;
+		}
+		spill();
+	}
+
+	for (int fd : segments)
+		close(fd);
+	segments.clear();
+	rmdir(directory.c_str());
+	open_buckets.clear();
+	closed_buckets.clear();
+	closed_extents.clear();
+	buffered_records = 0;
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+bool ExternalAStar::expandBucket(int g_val, int h_val, ExternalBucket& bucket, ExternalRecord& goal)
+{
+	num_of_buckets++;
+	auto byLocation = [](const ExternalRecord& a, const ExternalRecord& b) { return a.location < b.location; };
+	auto sameLocation = [](const ExternalRecord& a, const ExternalRecord& b) { return a.location == b.location; };
+
+	// phase 1: sorted runs of deduplicated records
+	size_t chunk_records = max((size_t)MIN_BLOCK_RECORDS, (size_t)(max_memory / 2 / sizeof(ExternalRecord)));
+	vector<ExternalRecord> chunk;
+	vector<ExternalBucket> runs;
+	buffered_records -= bucket.buffer.size();
+	if (bucket.extents.empty())
+	{
+		chunk = std::move(bucket.buffer);
+		std::sort(chunk.begin(), chunk.end(), byLocation);
+		chunk.erase(std::unique(chunk.begin(), chunk.end(), sameLocation), chunk.end());
+	}
+	else
+	{
+		BucketReader reader(&bucket, getBlockSize(2));
+		while (!reader.empty())
+		{
+			chunk.clear();
+			while (!reader.empty() && chunk.size() < chunk_records)
+			{
+				chunk.push_back(reader.top());
+				reader.pop();
+			}
+			std::sort(chunk.begin(), chunk.end(), byLocation);
+			chunk.erase(std::unique(chunk.begin(), chunk.end(), sameLocation), chunk.end());
+			if (reader.empty() && runs.empty())
+				break; // the bucket fits into memory
+			runs.emplace_back();
+			runs.back().size = chunk.size();
+			runs.back().buffer.swap(chunk);
+			buffered_records += runs.back().size;
+			flush({&runs.back()});
+		}
+		release(bucket);
+	}
+
+	// phase 2: merge the runs, subtract the CLOSED buckets (g - 1, h) and (g - 2, h) and expand the remaining records
+	size_t block_records = getBlockSize((int)runs.size() + 2);
+	ExternalBucket sealed1, sealed2;
+	BucketReader closed1(getClosedBucket(g_val - 1, h_val, sealed1), block_records);
+	BucketReader closed2(getClosedBucket(g_val - 2, h_val, sealed2), block_records);
+	ExternalBucket& closed = closed_buckets[make_pair(g_val, h_val)];
+	bool found = false;
+	auto process = [&](const ExternalRecord& record)
+	{
+		while (!closed1.empty() && closed1.top().location < record.location)
+			closed1.pop();
+		while (!closed2.empty() && closed2.top().location < record.location)
+			closed2.pop();
+		if ((!closed1.empty() && closed1.top().location == record.location) ||
+			(!closed2.empty() && closed2.top().location == record.location))
+			return true; // duplicate
+		push(closed, record);
+		if (record.location == goal_location)
+		{
+			goal = record;
+			found = true;
+			return false;
+		}
+		num_expanded++;
+		for (int next_location : instance.getNeighbors(record.location))
+		{
+			int next_h_val = compute_heuristic(next_location, goal_location);
+			if (next_h_val >= MAX_COST) // next_location cannot reach the goal
+				continue;
+			push(open_buckets[make_pair(g_val + 1 + next_h_val, g_val + 1)], {next_location, record.location});
+			open_size++;
+			num_generated++;
+		}
+		return true;
+	};
+
+	if (runs.empty())
+	{
+		for (const auto& record : chunk)
+			if (!process(record))
+				break;
+	}
+	else
+	{
+		vector<std::unique_ptr<BucketReader> > readers;
+		typedef pair<int, int> entry; // (location, run index)
+		std::priority_queue<entry, vector<entry>, std::greater<entry> > heap;
+		for (size_t i = 0; i < runs.size(); i++)
+		{
+			readers.emplace_back(new BucketReader(&runs[i], block_records));
+			if (!readers.back()->empty())
+				heap.emplace(readers.back()->top().location, (int)i);
+		}
+		int last_location = -1;
+		while (!heap.empty())
+		{
+			int i = heap.top().second;
+			heap.pop();
+			ExternalRecord record = readers[i]->top();
+			readers[i]->pop();
+			if (!readers[i]->empty())
+				heap.emplace(readers[i]->top().location, i);
+			if (record.location == last_location)
+				continue;
+			last_location = record.location;
+			if (!process(record))
+				break;
+		}
+		readers.clear();
+		for (const auto& run : runs)
+			release(run);
+	}
+	peak_open_size = max(peak_open_size, open_size);
+	return found;
+}
+
+
+void ExternalAStar::push(ExternalBucket& bucket, const ExternalRecord& record)
+{
+	bucket.buffer.push_back(record);
+	bucket.size++;
+	buffered_records++;
+	// large buffers are written while a bucket is expanded, the others by spill() afterwards
+	if (bucket.buffer.size() >= MAX_BLOCK_RECORDS && buffered_records * sizeof(ExternalRecord) > max_memory / 2)
+		flush({&bucket});
+}
+
+
+void ExternalAStar::flush(const vector<ExternalBucket*>& buckets)
+{
+	if (segments.empty() || segment_size * sizeof(ExternalRecord) >= MAX_SEGMENT_BYTES)
+	{
+		// the segment is unlinked right away, so it is deleted when it is closed (even if the search is killed)
+		string fileName = directory + "/s" + std::to_string(segments.size());
+		int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd < 0)
+		{
+			cerr << "Fail to create segment file " << fileName << endl;
+			exit(-1);
+		}
+		unlink(fileName.c_str());
+		segments.push_back(fd);
+		segment_size = 0;
+	}
+
+	int fd = segments.back();
+	for (auto bucket : buckets)
+	{
+		const char* data = reinterpret_cast<const char*>(bucket->buffer.data());
+		size_t length = bucket->buffer.size() * sizeof(ExternalRecord), done = 0;
+		while (done < length)
+		{
+			ssize_t n = pwrite(fd, data + done, length - done, segment_size * sizeof(ExternalRecord) + done);
+			if (n <= 0)
+			{
+				cerr << "Fail to write a segment file" << endl;
+				exit(-1);
+			}
+			done += n;
+		}
+		bucket->extents.push_back({fd, (off_t)segment_size, bucket->buffer.size()});
+		segment_size += bucket->buffer.size();
+		bytes_written += length;
+		buffered_records -= bucket->buffer.size();
+		bucket->buffer.clear();
+		bucket->buffer.shrink_to_fit();
+	}
+}
+
+
+// write the CLOSED buckets with the smallest g first (they are only needed to recover the path), and then the OPEN
+// buckets that will be expanded last, until the buffers take at most half of their budget
+void ExternalAStar::spill()
+{
+	uint64_t budget = max_memory / 2 / sizeof(ExternalRecord);
+	if (buffered_records <= budget)
+		return;
+	vector<ExternalBucket*> buckets;
+	uint64_t remaining = buffered_records;
+	auto closed_end = closed_buckets.begin();
+	for (; closed_end != closed_buckets.end() && remaining > budget / 2; ++closed_end)
+	{
+		buckets.push_back(&closed_end->second);
+		remaining -= closed_end->second.buffer.size();
+	}
+	for (auto it = open_buckets.rbegin(); it != open_buckets.rend() && remaining > budget / 2; ++it)
+	{
+		if (it->second.buffer.empty())
+			continue;
+		buckets.push_back(&it->second);
+		remaining -= it->second.buffer.size();
+	}
+	flush(buckets);
+
+	// keep only the extents of the written CLOSED buckets
+	for (auto it = closed_buckets.begin(); it != closed_end; it = closed_buckets.erase(it))
+	{
+		int g_val = it->first.first, h_val = it->first.second;
+		if ((int)closed_extents.size() <= g_val)
+			closed_extents.resize(g_val + 1);
+		auto& extents = closed_extents[g_val];
+		auto pos = std::upper_bound(extents.begin(), extents.end(), h_val,
+			[](int h, const pair<int, ExternalExtent>& entry) { return h < entry.first; });
+		for (const auto& extent : it->second.extents)
+			pos = extents.insert(pos, make_pair(h_val, extent)) + 1;
+	}
+}
+
+
+// the CLOSED bucket (g_val, h_val), or nullptr if it does not exist (written buckets are rebuilt in sealed)
+const ExternalBucket* ExternalAStar::getClosedBucket(int g_val, int h_val, ExternalBucket& sealed) const
+{
+	auto it = closed_buckets.find(make_pair(g_val, h_val));
+	if (it != closed_buckets.end())
+		return &it->second;
+	if (g_val < 0 || g_val >= (int)closed_extents.size())
+		return nullptr;
+	const auto& extents = closed_extents[g_val];
+	auto pos = std::lower_bound(extents.begin(), extents.end(), h_val,
+		[](const pair<int, ExternalExtent>& entry, int h) { return entry.first < h; });
+	for (; pos != extents.end() && pos->first == h_val; ++pos)
+	{
+		sealed.extents.push_back(pos->second);
+		sealed.size += pos->second.num_of_records;
+	}
+	return sealed.extents.empty() ? nullptr : &sealed;
+}
+
+
+void ExternalAStar::release(const ExternalBucket& bucket) const
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+	for (const auto& extent : bucket.extents)
+		if (extent.num_of_records >= MAX_BLOCK_RECORDS) // small holes do not free whole blocks
+			fallocate(extent.fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				extent.offset * sizeof(ExternalRecord), extent.num_of_records * sizeof(ExternalRecord));
+#endif
+}
+
+
+// binary search in the extents and the buffer of the sorted CLOSED bucket of location
+bool ExternalAStar::findRecord(int location, int g_val, ExternalRecord& record) const
+{
+	ExternalBucket sealed;
+	const ExternalBucket* closed = getClosedBucket(g_val, compute_heuristic(location, goal_location), sealed);
+	if (closed == nullptr)
+		return false;
+	const ExternalBucket& bucket = *closed;
+	for (const auto& extent : bucket.extents)
+	{
+		off_t low = extent.offset, high = extent.offset + extent.num_of_records;
+		while (low < high)
+		{
+			off_t mid = (low + high) / 2;
+			if (pread(extent.fd, &record, sizeof(ExternalRecord), mid * sizeof(ExternalRecord)) != sizeof(ExternalRecord))
+				break;
+			if (record.location < location)
+				low = mid + 1;
+			else if (record.location > location)
+				high = mid;
+			else
+				return true;
+		}
+	}
+	auto pos = std::lower_bound(bucket.buffer.begin(), bucket.buffer.end(), location,
+		[](const ExternalRecord& a, int loc) { return a.location < loc; });
+	if (pos == bucket.buffer.end() || pos->location != location)
+		return false;
+	record = *pos;
+	return true;
+}
+
+
+// split the sorting half of the memory budget among the streams (each holds two blocks for prefetching)
+size_t ExternalAStar::getBlockSize(int num_of_streams) const
+{
+	size_t block_records = max_memory / 2 / sizeof(ExternalRecord) / (2 * num_of_streams);
+	return max((size_t)MIN_BLOCK_RECORDS, min((size_t)MAX_BLOCK_RECORDS, block_records));
+}
@@ -14,6 +14,7 @@ __device__ void getNeighbors(int curr, int* neighbors, int* n_size, const Instan
 __device__ int compute_heuristic(int loc1, int loc2, const Instance *instance);
 __device__ int getRowCoordinate(int id, const Instance *instance);
 __device__ int getColCoordinate(int id, const Instance *instance);
+__device__ int linearizeCoordinate(int row, int col, const Instance *instance);
 
 __device__ int total_open_list_size = 0;
 __device__ int found = 0;
@@ -204,7 +205,16 @@ __global__ void push_to_queues(int k, heap **open_list, llist *S, int off) {
 }
 
 __device__ void getNeighbors(int curr, int* neighbors, int* n_size, const Instance *instance, bool *my_map) {
-	int candidates[4] = {curr + 1, curr - 1, curr + instance->num_of_cols, curr - instance->num_of_cols};
+	int row = getRowCoordinate(curr, instance), col = getColCoordinate(curr, instance);
+	int candidates[4] = {-1, -1, -1, -1}; // right, left, down, up (see Instance::linearizeCoordinate)
+	if (col < instance->num_of_cols - 1)
+		candidates[0] = linearizeCoordinate(row, col + 1, instance);
+	if (col > 0)
+		candidates[1] = linearizeCoordinate(row, col - 1, instance);
+	if (row < instance->num_of_rows - 1)
+		candidates[2] = linearizeCoordinate(row + 1, col, instance);
+	if (row > 0)
+		candidates[3] = linearizeCoordinate(row - 1, col, instance);
 	*n_size = 0;
 	for (int i=0; i<4; i++)
 	{
@@ -271,5 +281,19 @@ void updatePath(const GNode* goal, vector<PathEntry> &path)
     std::reverse(path.begin(),path.end());
 }
 
-__device__ int getRowCoordinate(int id, const Instance *instance) { return id / instance->num_of_cols; }
-__device__ int getColCoordinate(int id, const Instance *instance) { return id % instance->num_of_cols; }
\ No newline at end of file
+__device__ int getRowCoordinate(int id, const Instance *instance)
+{
+	return ((id >> 2 * instance->tile_shift) / instance->num_of_tile_cols) << instance->tile_shift |
+		((id >> instance->tile_shift) & instance->tile_mask);
+}
+__device__ int getColCoordinate(int id, const Instance *instance)
+{
+	return ((id >> 2 * instance->tile_shift) % instance->num_of_tile_cols) << instance->tile_shift |
+		(id & instance->tile_mask);
+}
+__device__ int linearizeCoordinate(int row, int col, const Instance *instance)
+{
+	int tile = (row >> instance->tile_shift) * instance->num_of_tile_cols + (col >> instance->tile_shift);
+	return (((tile << instance->tile_shift) | (row & instance->tile_mask)) << instance->tile_shift) |
+		(col & instance->tile_mask);
+}
\ No newline at end of file
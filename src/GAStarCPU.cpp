@@ -0,0 +1,259 @@
+#include <thread>
+#include "GAStarCPU.h"
+
+
+void StepBarrier::wait()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	uint64_t curr_generation = generation;
+	if (++num_of_waiting == num_of_threads)
+	{
+		num_of_waiting = 0;
+		generation++;
+		condition.notify_all();
+		return;
+	}
+	condition.wait(guard, [&] { return generation != curr_generation; });
+}
+
+
+GAStarCPU::GAStarCPU(const Instance& instance, int agent, int num_of_threads, int queues_per_thread):
+	SingleAgentSolver(instance, agent), num_of_threads(max(num_of_threads, 1)),
+	queues_per_thread(max(queues_per_thread, 1)), num_of_queues(this->num_of_threads * this->queues_per_thread)
+{
+	nproc = this->num_of_threads;
+}
+
+
+Path GAStarCPU::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path GAStarCPU::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 1;
+	num_allocated = 1;
+	peak_open_size = 1;
+	num_of_steps = 0;
+	best_goal = nullptr;
+	done = false;
+	corridor = instance.map_index.getCorridor(start_location, goal_location);
+	if (!corridor.isReachable())
+	{
+		planned_path = path;
+		path_cost = -1;
+		return path;
+	}
+
+	hash_size = HASH_SIZE;
+	while (hash_size < 2 * (size_t)instance.map_size)
+		hash_size <<= 1;
+	hash_table.reset(new std::atomic<GNode*>[hash_size]);
+	for (size_t i = 0; i < hash_size; i++)
+		hash_table[i].store(nullptr, std::memory_order_relaxed);
+	threads.clear();
+	threads.resize(num_of_threads);
+	for (auto& data : threads)
+		data.heaps.resize(queues_per_thread);
+
+	threads[0].nodes.push_back({start_location, 0, compute_heuristic(start_location, goal_location), nullptr, 0});
+	GNode* start = &threads[0].nodes.back();
+	hash_table[getHash(0, start_location)].store(start);
+	threads[0].heaps[0].push(start);
+
+	StepBarrier barrier(num_of_threads);
+	vector<std::thread> workers;
+	for (int i = 1; i < num_of_threads; i++)
+		workers.emplace_back(&GAStarCPU::search, this, i, std::ref(barrier));
+	search(0, barrier);
+	for (auto& worker : workers)
+		worker.join();
+
+	for (const auto& data : threads)
+	{
+		num_expanded += data.expanded;
+		num_generated += data.generated;
+		num_allocated += data.nodes.size();
+	}
+	if (best_goal != nullptr)
+	{
+		path.resize(best_goal->g_val + 1);
+		for (const GNode* curr = best_goal; curr != nullptr; curr = curr->parent)
+			path[curr->g_val] = curr->location;
+	}
+
+	threads.clear();
+	successors.clear();
+	hash_table.reset();
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+void GAStarCPU::search(int thread_id, StepBarrier& barrier)
+{
+	ThreadData& data = threads[thread_id];
+	while (true)
+	{
+		expand(data);
+		barrier.wait();
+		deduplicate(data);
+		barrier.wait();
+		if (thread_id == 0) // gather S and the best goal node
+		{
+			successors.clear();
+			for (auto& other : threads)
+			{
+				for (auto node : other.successors)
+					if (node != nullptr)
+						successors.push_back(node);
+				if (other.goal != nullptr && (best_goal == nullptr || other.goal->g_val < best_goal->g_val))
+					best_goal = other.goal;
+			}
+		}
+		barrier.wait();
+		push(thread_id);
+		barrier.wait();
+		if (thread_id == 0)
+		{
+			int min_f_val = MAX_COST;
+			uint64_t open_size = 0;
+			for (const auto& other : threads)
+			{
+				min_f_val = min(min_f_val, other.min_f_val);
+				for (const auto& heap : other.heaps)
+					open_size += heap.size();
+			}
+			peak_open_size = max(peak_open_size, open_size);
+			num_of_steps++;
+			done = min_f_val == MAX_COST || (best_goal != nullptr && best_goal->g_val <= min_f_val);
+		}
+		barrier.wait();
+		if (done)
+			return;
+	}
+}
+
+
+// extract the best node of every heap of this thread and expand it into S
+void GAStarCPU::expand(ThreadData& data)
+{
+	data.successors.clear();
+	int upper_bound = best_goal == nullptr ? MAX_COST : best_goal->g_val;
+	for (auto& heap : data.heaps)
+	{
+		if (heap.empty())
+			continue;
+		GNode* curr = heap.top();
+		heap.pop();
+		if (isStale(curr))
+			continue;
+		if (curr->location == goal_location)
+		{
+			if (data.goal == nullptr || curr->g_val < data.goal->g_val)
+				data.goal = curr;
+			continue;
+		}
+		data.expanded++;
+		int next_locations[4], next_h_vals[4];
+		int num_of_neighbors = instance.getSuccessors(curr->location, goal_location, next_locations, next_h_vals);
+		for (int j = 0; j < num_of_neighbors; j++)
+		{
+			if (goal_distances != nullptr)
+				next_h_vals[j] = goal_distances.get()[next_locations[j]];
+			if (curr->g_val + 1 + next_h_vals[j] >= upper_bound ||
+				!instance.map_index.inCorridor(corridor, next_locations[j]))
+				continue;
+			data.nodes.push_back({next_locations[j], curr->g_val + 1, next_h_vals[j], curr, curr->timestep + 1});
+			data.successors.push_back(&data.nodes.back());
+		}
+	}
+}
+
+
+// Insert every node of this thread's part of S into H at the first slot of its probe sequence that is empty or holds
+// the same location. Slots are never emptied, so a location is always found before the first empty slot of its
+// sequence. A node is removed from S if H already holds its location with a g-val that is no larger.
+void GAStarCPU::deduplicate(ThreadData& data)
+{
+	for (auto& node : data.successors)
+	{
+		for (int j = 0; j < HASH_FUNS; j++)
+		{
+			auto& slot = hash_table[getHash(j, node->location)];
+			GNode* curr = slot.load();
+			bool next_slot = false;
+			while (!next_slot)
+			{
+				if (curr != nullptr && curr->location != node->location)
+					next_slot = true;
+				else if (curr != nullptr && curr->g_val <= node->g_val)
+				{
+					node = nullptr; // duplicate
+					break;
+				}
+				else if (slot.compare_exchange_weak(curr, node))
+					break;
+			}
+			if (!next_slot)
+				break;
+		}
+	}
+}
+
+
+// distribute S round-robin over all heaps (shifted by the step), each thread filling its own heaps
+void GAStarCPU::push(int thread_id)
+{
+	ThreadData& data = threads[thread_id];
+	data.min_f_val = MAX_COST;
+	for (int i = 0; i < queues_per_thread; i++)
+	{
+		int queue = thread_id * queues_per_thread + i;
+		size_t first = (queue + num_of_queues - num_of_steps % num_of_queues) % num_of_queues;
+		auto& heap = data.heaps[i];
+		for (size_t j = first; j < successors.size(); j += num_of_queues)
+		{
+			heap.push(successors[j]);
+			data.generated++;
+		}
+		if (!heap.empty())
+			data.min_f_val = min(data.min_f_val, heap.top()->g_val + heap.top()->h_val);
+	}
+}
+
+
+bool GAStarCPU::isStale(const GNode* node) const
+{
+	for (int j = 0; j < HASH_FUNS; j++)
+	{
+		const GNode* curr = hash_table[getHash(j, node->location)].load();
+		if (curr == nullptr)
+			return false;
+		if (curr->location == node->location)
+			return curr->g_val < node->g_val;
+	}
+	return false;
+}
+
+
+// Jenkins' one-at-a-time hash of the location, seeded by the index of the hash function
+size_t GAStarCPU::getHash(int j, int location) const
+{
+	uint32_t hash = j * 10000007u;
+	for (int i = 0; i < 4; i++)
+	{
+		hash += (location >> (8 * i)) & 0xff;
+		hash += hash << 10;
+		hash ^= hash >> 6;
+	}
+	hash += hash << 3;
+	hash ^= hash >> 11;
+	hash += hash << 15;
+	return hash & (hash_size - 1);
+}
@@ -0,0 +1,95 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "GridMap.h"
+
+
+GridMap& GridMap::operator=(const GridMap& other)
+{
+	map_size = other.map_size;
+	storage = other.storage;
+	owner = other.owner;
+	words = other.isAttached() ? other.words : storage.data();
+	return *this;
+}
+
+
+void GridMap::set(int loc, bool obstacle)
+{
+	assert(!isAttached());
+	if (obstacle)
+		storage[loc >> 6] |= (uint64_t)1 << (loc & 63);
+	else
+		storage[loc >> 6] &= ~((uint64_t)1 << (loc & 63));
+}
+
+
+void GridMap::resize(int size, bool obstacle)
+{
+	owner.reset();
+	map_size = size;
+	storage.assign(getNumOfWords(size), obstacle ? ~(uint64_t)0 : 0);
+	words = storage.data();
+}
+
+
+void GridMap::attach(const uint64_t* bits, int size, shared_ptr<const void> owner)
+{
+	storage.clear();
+	map_size = size;
+	words = bits;
+	this->owner = owner;
+}
+
+
+bool loadBinaryMap(const string& fileName, int& num_of_rows, int& num_of_cols, GridMap& map)
+{
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	char header[BINARY_MAP_HEADER_SIZE];
+	struct stat st;
+	if (read(fd, header, BINARY_MAP_HEADER_SIZE) != BINARY_MAP_HEADER_SIZE ||
+		memcmp(header, BINARY_MAP_MAGIC, 8) != 0 || fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	int32_t dims[2];
+	memcpy(dims, header + 8, sizeof(dims));
+	// the cells are indexed by int
+	size_t size = dims[0] > 0 && dims[1] > 0 ? (size_t)dims[0] * (size_t)dims[1] : 0;
+	size_t length = BINARY_MAP_HEADER_SIZE + GridMap::getNumOfWords(size) * sizeof(uint64_t);
+	if (size == 0 || size > INT_MAX || (size_t)st.st_size < length)
+	{
+		close(fd);
+		return false;
+	}
+	void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return false;
+	num_of_rows = dims[0];
+	num_of_cols = dims[1];
+	shared_ptr<const void> mapping(addr, [length](const void* p) { munmap(const_cast<void*>(p), length); });
+	map.attach(reinterpret_cast<const uint64_t*>(static_cast<const char*>(addr) + BINARY_MAP_HEADER_SIZE),
+		num_of_rows * num_of_cols, mapping);
+	return true;
+}
+
+
+bool saveBinaryMap(const string& fileName, int num_of_rows, int num_of_cols, const GridMap& map)
+{
+	ofstream output(fileName, std::ios::binary);
+	if (!output.is_open())
+		return false;
+	char header[BINARY_MAP_HEADER_SIZE] = {};
+	int32_t dims[2] = {num_of_rows, num_of_cols};
+	memcpy(header, BINARY_MAP_MAGIC, 8);
+	memcpy(header + 8, dims, sizeof(dims));
+	output.write(header, BINARY_MAP_HEADER_SIZE);
+	output.write(reinterpret_cast<const char*>(map.data()), GridMap::getNumOfWords(map.size()) * sizeof(uint64_t));
+	return output.good();
+}
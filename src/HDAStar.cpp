@@ -66,7 +66,7 @@ void HDAStar::send_message_set()
         {
             send_requests[i] = new MPI_Request;
             send_buffers[i].assign(message_set[i].begin(), message_set[i].end()); //copy data into send buffer   
-            MPI_Isend(&send_buffers[i][0], message_set[i].size(), MPI_Msg, i, tag, MPI_COMM_WORLD, send_requests[i]);
+            MPI_Isend(&send_buffers[i][0], message_set[i].size(), MPI_Msg, i, tag, comm, send_requests[i]);
             tag += 1;
             message_set[i].clear(); //clear data
         }
@@ -78,17 +78,17 @@ int HDAStar::receive_message_set()
 {
     int flag, size;
     MPI_Status status;
-    MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+    MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &flag, &status);
     int buf_size=0;
     
     while(flag)
     {
         MPI_Get_count(&status, MPI_Msg, &size);
         //receive_buffer   
-        MPI_Recv(recv_buffer+buf_size, size, MPI_Msg, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(recv_buffer+buf_size, size, MPI_Msg, status.MPI_SOURCE, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
         buf_size += size;
 
-        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &flag, &status);
     }
     // for (int i=0; i<buf_size; i++) {
     //     auto node = recv_buffer[i].node;
@@ -209,12 +209,12 @@ Path HDAStar::findSuboptimalPath()
     if (dst_pid != pid)
     {
         //in this broadcast we will wait for information about whether the destination has been found
-        MPI_Ibcast(&path_cost, 1, MPI_INT, dst_pid, MPI_COMM_WORLD, &dst_req);
+        MPI_Ibcast(&path_cost, 1, MPI_INT, dst_pid, comm, &dst_req);
     }
 
     //register mpi data type
     create_msg_mpi_datatype();
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(comm);
 
     //receive any message from anywhere 
     message_set.resize(nproc);
@@ -251,7 +251,7 @@ Path HDAStar::findSuboptimalPath()
                 }
                 path_cost = curr->getFVal();
                 // broadcast the cost of this path to all processors
-                MPI_Ibcast(&path_cost, 1, MPI_INT, dst_pid, MPI_COMM_WORLD, &dst_req);
+                MPI_Ibcast(&path_cost, 1, MPI_INT, dst_pid, comm, &dst_req);
                 continue;
             }
 
@@ -292,7 +292,7 @@ Path HDAStar::findSuboptimalPath()
             } else {
                 if(!in_barrier_mode)
                 {
-                    MPI_Ibarrier(MPI_COMM_WORLD, &barrier_req);
+                    MPI_Ibarrier(comm, &barrier_req);
                     in_barrier_mode = true;
                 } else {
                     MPI_Test(&barrier_req, &barrier_flag, MPI_STATUS_IGNORE);
@@ -306,7 +306,7 @@ Path HDAStar::findSuboptimalPath()
                                 to_send = 0;
                         }
 
-                        MPI_Allreduce(&to_send, &to_recv, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+                        MPI_Allreduce(&to_send, &to_recv, 1, MPI_INT, MPI_SUM, comm);
                         if (to_recv == 0)
                         {
                             std::cout << "Program Finished executing.. " << std::endl;
@@ -0,0 +1,418 @@
+#include <thread>
+#include <atomic>
+#include <queue>
+#include "HPAStar.h"
+
+#define MAX_ENTRANCE_WIDTH 6 // entrances of this width or wider get a transition at each end
+
+
+HPAGraph::HPAGraph(const Instance& instance, int cluster_size, int num_of_threads):
+	instance(instance), cluster_size(cluster_size)
+{
+	Timer timer;
+	num_of_cluster_rows = (instance.num_of_rows + cluster_size - 1) / cluster_size;
+	num_of_cluster_cols = (instance.num_of_cols + cluster_size - 1) / cluster_size;
+	node_id.resize(instance.map_size, -1);
+	cluster_nodes.resize(num_of_cluster_rows * num_of_cluster_cols);
+	addEntrances();
+
+	// clusters are independent, so the intra-edges are computed in parallel
+	std::atomic<int> next_cluster(0);
+	auto worker = [&]()
+	{
+		for (int cluster = next_cluster++; cluster < (int)cluster_nodes.size(); cluster = next_cluster++)
+			connectCluster(cluster);
+	};
+	vector<std::thread> threads;
+	for (int i = 1; i < num_of_threads; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+	preprocessing_time = timer.elapsed();
+}
+
+
+int HPAGraph::addNode(int loc)
+{
+	if (node_id[loc] < 0)
+	{
+		node_id[loc] = (int)nodes.size();
+		nodes.push_back(loc);
+		edges.emplace_back();
+		cluster_nodes[getCluster(loc)].push_back(node_id[loc]);
+	}
+	return node_id[loc];
+}
+
+
+void HPAGraph::addTransition(int loc1, int loc2)
+{
+	int id1 = addNode(loc1);
+	int id2 = addNode(loc2);
+	edges[id1].emplace_back(id2, 1);
+	edges[id2].emplace_back(id1, 1);
+}
+
+
+// scan every border between two adjacent clusters for maximal segments that are free on both sides
+void HPAGraph::addEntrances()
+{
+	for (int horizontal = 0; horizontal < 2; horizontal++)
+	{
+		// horizontal borders separate vertically adjacent clusters
+		int num_of_borders = horizontal ? num_of_cluster_rows - 1 : num_of_cluster_cols - 1;
+		int length = horizontal ? instance.num_of_cols : instance.num_of_rows;
+		for (int border = 1; border <= num_of_borders; border++)
+		{
+			auto side = [&](int i, int offset)
+			{
+				return horizontal ? instance.linearizeCoordinate(border * cluster_size + offset, i) :
+					instance.linearizeCoordinate(i, border * cluster_size + offset);
+			};
+			int begin = 0;
+			while (begin < length)
+			{
+				// an entrance never spans two clusters along the border
+				int end = begin;
+				int limit = min(length, (begin / cluster_size + 1) * cluster_size);
+				while (end < limit && !instance.isObstacle(side(end, -1)) && !instance.isObstacle(side(end, 0)))
+					end++;
+				if (end == begin)
+				{
+					begin++;
+					continue;
+				}
+				if (end - begin < MAX_ENTRANCE_WIDTH)
+				{
+					int mid = (begin + end - 1) / 2;
+					addTransition(side(mid, -1), side(mid, 0));
+				}
+				else
+				{
+					addTransition(side(begin, -1), side(begin, 0));
+					addTransition(side(end - 1, -1), side(end - 1, 0));
+				}
+				begin = end;
+			}
+		}
+	}
+}
+
+
+void HPAGraph::connectCluster(int cluster)
+{
+	vector< pair<int, int> > distances;
+	int target_distance;
+	for (int id : cluster_nodes[cluster])
+	{
+		distances.clear();
+		getIntraDistances(nodes[id], distances, -1, target_distance);
+		for (const auto& entry : distances)
+		{
+			if (entry.first != id)
+				edges[id].push_back(entry);
+		}
+	}
+}
+
+
+void HPAGraph::getIntraDistances(int loc, vector< pair<int, int> >& distances, int target, int& target_distance) const
+{
+	int cluster = getCluster(loc);
+	int row0 = (cluster / num_of_cluster_cols) * cluster_size;
+	int col0 = (cluster % num_of_cluster_cols) * cluster_size;
+	int rows = min(cluster_size, instance.num_of_rows - row0);
+	int cols = min(cluster_size, instance.num_of_cols - col0);
+	auto local = [&](int l) { return (instance.getRowCoordinate(l) - row0) * cols + instance.getColCoordinate(l) - col0; };
+
+	target_distance = MAX_COST;
+	vector<int> dist(rows * cols, MAX_COST);
+	std::queue<int> open;
+	dist[local(loc)] = 0;
+	open.push(loc);
+	while (!open.empty())
+	{
+		int curr = open.front(); open.pop();
+		int d = dist[local(curr)];
+		if (node_id[curr] >= 0)
+			distances.emplace_back(node_id[curr], d);
+		if (curr == target)
+			target_distance = d;
+		for (int next : instance.getNeighbors(curr))
+		{
+			if (getCluster(next) != cluster || dist[local(next)] <= d + 1)
+				continue;
+			dist[local(next)] = d + 1;
+			open.push(next);
+		}
+	}
+}
+
+
+int HPAGraph::getNumOfEdges() const
+{
+	int num_of_edges = 0;
+	for (const auto& e : edges)
+		num_of_edges += (int)e.size();
+	return num_of_edges;
+}
+
+
+// binary layout: rows, cols, the hash of the map (uint64), cluster size, #nodes,
+// then for each node its location (row-major), #edges and edges
+bool HPAGraph::save(const string& fileName) const
+{
+	ofstream output(fileName, std::ios::binary);
+	if (!output.is_open())
+		return false;
+	auto write_int = [&](int value) { output.write(reinterpret_cast<const char*>(&value), sizeof(int)); };
+	write_int(instance.num_of_rows);
+	write_int(instance.num_of_cols);
+	uint64_t map_hash = instance.getMapHash();
+	output.write(reinterpret_cast<const char*>(&map_hash), sizeof(map_hash));
+	write_int(cluster_size);
+	write_int((int)nodes.size());
+	for (size_t id = 0; id < nodes.size(); id++)
+	{
+		write_int(instance.getRowCoordinate(nodes[id]) * instance.num_of_cols + instance.getColCoordinate(nodes[id]));
+		write_int((int)edges[id].size());
+		output.write(reinterpret_cast<const char*>(edges[id].data()), edges[id].size() * sizeof(pair<int, int>));
+	}
+	return output.good();
+}
+
+
+HPAGraph::HPAGraph(const Instance& instance, const string& fileName): instance(instance)
+{
+	Timer timer;
+	std::ifstream input(fileName, std::ios::binary);
+	if (!input.is_open())
+		return;
+	auto read_int = [&]() { int value = -1; input.read(reinterpret_cast<char*>(&value), sizeof(int)); return value; };
+	int rows = read_int();
+	int cols = read_int();
+	uint64_t map_hash = 0;
+	input.read(reinterpret_cast<char*>(&map_hash), sizeof(map_hash));
+	cluster_size = read_int();
+	if (rows != instance.num_of_rows || cols != instance.num_of_cols || map_hash != instance.getMapHash() ||
+		cluster_size <= 0)
+		return;
+	num_of_cluster_rows = (instance.num_of_rows + cluster_size - 1) / cluster_size;
+	num_of_cluster_cols = (instance.num_of_cols + cluster_size - 1) / cluster_size;
+	node_id.resize(instance.map_size, -1);
+	cluster_nodes.resize(num_of_cluster_rows * num_of_cluster_cols);
+	int num_of_nodes = read_int();
+	if (num_of_nodes < 0 || num_of_nodes > rows * cols)
+		input.setstate(std::ios::failbit);
+	for (int id = 0; id < num_of_nodes && input.good(); id++)
+	{
+		int loc = read_int();
+		// every node has its own free location
+		if (loc < 0 || loc >= rows * cols ||
+			instance.isObstacle(instance.linearizeCoordinate(loc / cols, loc % cols)) ||
+			addNode(instance.linearizeCoordinate(loc / cols, loc % cols)) != id)
+		{
+			input.setstate(std::ios::failbit);
+			break;
+		}
+		int num_of_edges = read_int();
+		if (num_of_edges < 0 || num_of_edges >= num_of_nodes)
+		{
+			input.setstate(std::ios::failbit);
+			break;
+		}
+		edges[id].resize(num_of_edges);
+		input.read(reinterpret_cast<char*>(edges[id].data()), edges[id].size() * sizeof(pair<int, int>));
+		for (const auto& edge : edges[id])
+			if (edge.first < 0 || edge.first >= num_of_nodes || edge.first == id || edge.second <= 0 ||
+				edge.second >= MAX_COST)
+				input.setstate(std::ios::failbit);
+	}
+	if (!input.good())
+	{
+		cerr << "Abstract graph file " << fileName << " is corrupted." << endl;
+		nodes.clear();
+		edges.clear();
+	}
+	preprocessing_time = timer.elapsed();
+}
+
+
+Path HPAStar::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path HPAStar::findSuboptimalPath()
+{
+	struct Node
+	{
+		int id;
+		int g_val;
+		int f_val;
+
+		Node() = default;
+		Node(int id, int g_val, int f_val) : id(id), g_val(g_val), f_val(f_val) {}
+		struct compare_node
+		{
+			// returns true if n1 > n2 (note -- this gives us *min*-heap).
+			bool operator()(const Node& n1, const Node& n2) const
+			{
+				if (n1.f_val == n2.f_val)
+					return n1.g_val <= n2.g_val;  // break ties towards larger g_vals
+				return n1.f_val >= n2.f_val;
+			}
+		};
+	};
+
+	Path path;
+	num_expanded = 0;
+	num_generated = 0;
+
+	// short queries are cheaper (and optimal) on the grid itself
+	if (compute_heuristic(start_location, goal_location) <= graph.cluster_size)
+	{
+		updatePath({start_location, goal_location}, path);
+		planned_path = path;
+		path_cost = path.size() - 1;
+		return path;
+	}
+
+	// insert start and goal into the abstract graph as two extra nodes
+	int num_of_nodes = graph.getNumOfNodes();
+	int start_id = num_of_nodes, goal_id = num_of_nodes + 1;
+	vector< pair<int, int> > start_edges, goal_edges;
+	int direct_cost, unused;
+	graph.getIntraDistances(start_location, start_edges, goal_location, direct_cost);
+	graph.getIntraDistances(goal_location, goal_edges, -1, unused);
+	vector<int> goal_costs(num_of_nodes, MAX_COST);
+	for (const auto& entry : goal_edges)
+		goal_costs[entry.first] = entry.second;
+
+	vector<int> g_vals(num_of_nodes + 2, MAX_COST);
+	vector<int> parents(num_of_nodes + 2, -1);
+	auto location = [&](int id) { return id == start_id ? start_location : id == goal_id ? goal_location : graph.nodes[id]; };
+	boost::heap::pairing_heap< Node, boost::heap::compare<Node::compare_node> > open_list;
+	g_vals[start_id] = 0;
+	open_list.push(Node(start_id, 0, compute_heuristic(start_location, goal_location)));
+	num_generated++;
+
+	auto generate = [&](int curr, int next, int cost)
+	{
+		int next_g_val = g_vals[curr] + cost;
+		if (next_g_val >= g_vals[next])
+			return;
+		g_vals[next] = next_g_val;
+		parents[next] = curr;
+		open_list.push(Node(next, next_g_val, next_g_val + compute_heuristic(location(next), goal_location)));
+		num_generated++;
+	};
+
+	bool found = false;
+	while (!open_list.empty())
+	{
+		Node curr = open_list.top();
+		open_list.pop();
+		if (curr.g_val > g_vals[curr.id]) // a better copy has been expanded
+			continue;
+		num_expanded++;
+		if (curr.id == goal_id)
+		{
+			found = true;
+			break;
+		}
+		if (curr.id == start_id)
+		{
+			for (const auto& entry : start_edges)
+				generate(curr.id, entry.first, entry.second);
+			if (direct_cost < MAX_COST)
+				generate(curr.id, goal_id, direct_cost);
+			continue;
+		}
+		for (const auto& entry : graph.edges[curr.id])
+			generate(curr.id, entry.first, entry.second);
+		if (goal_costs[curr.id] < MAX_COST)
+			generate(curr.id, goal_id, goal_costs[curr.id]);
+	}
+
+	if (found)
+	{
+		vector<int> abstract_path;
+		for (int id = goal_id; id >= 0; id = parents[id])
+			abstract_path.push_back(location(id));
+		std::reverse(abstract_path.begin(), abstract_path.end());
+		updatePath(abstract_path, path);
+		if (smooth)
+			smoothPath(path);
+	}
+
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+// refine each abstract edge with a low-level search between its two ends
+void HPAStar::updatePath(const vector<int>& abstract_path, vector<PathEntry> &path)
+{
+	std::unique_ptr<SearchContext> own_context;
+	SearchContext* search_context = context;
+	if (search_context == nullptr)
+	{
+		own_context.reset(new SearchContext(instance));
+		search_context = own_context.get();
+	}
+	path.emplace_back(abstract_path.front());
+	for (size_t i = 1; i < abstract_path.size(); i++)
+	{
+		if (abstract_path[i - 1] == abstract_path[i])
+			continue;
+		if (instance.getManhattanDistance(abstract_path[i - 1], abstract_path[i]) == 1) // inter-edge
+		{
+			path.emplace_back(abstract_path[i]);
+			continue;
+		}
+		SpaceTimeAStar planner(instance, trial_idx, abstract_path[i - 1], abstract_path[i], search_context);
+		Path segment = planner.findOptimalPath();
+		if (segment.empty())
+		{
+			path.clear();
+			return;
+		}
+		num_expanded += planner.num_expanded;
+		num_generated += planner.num_generated;
+		path.insert(path.end(), segment.begin() + 1, segment.end());
+	}
+}
+
+
+// greedily replace each subpath by a monotone path whenever it is longer than the Manhattan distance of its ends
+void HPAStar::smoothPath(vector<PathEntry> &path) const
+{
+	int window = 2 * graph.cluster_size;
+	vector<int> smoothed, shortcut;
+	smoothed.push_back(path.front().location);
+	int i = 0, n = (int)path.size() - 1;
+	while (i < n)
+	{
+		int next = i + 1;
+		for (int j = min(n, i + window); j > i + 1; j--)
+		{
+			if (instance.getManhattanDistance(path[i].location, path[j].location) >= j - i)
+				continue;
+			shortcut.clear();
+			if (instance.getMonotonePath(path[i].location, path[j].location, shortcut))
+			{
+				smoothed.insert(smoothed.end(), shortcut.begin(), shortcut.end());
+				next = j;
+				break;
+			}
+		}
+		if (next == i + 1)
+			smoothed.push_back(path[next].location);
+		i = next;
+	}
+	path.assign(smoothed.begin(), smoothed.end());
+}
@@ -0,0 +1,24 @@
+#include <atomic>
+#include "common.h"
+#include "HeapCounter.h"
+
+// The global operator new is replaced to count heap allocations, so that the driver can check that searches with a
+// reused SearchContext do not allocate. It lives in its own file rather than in driver.cpp so that it is never inlined,
+// and it is only linked into pastar, so that libpastar leaves the allocator of the programs that embed it alone.
+static std::atomic<uint64_t> num_of_heap_allocations(0);
+
+uint64_t getNumOfHeapAllocations()
+{
+	return num_of_heap_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	num_of_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = malloc(size == 0 ? 1 : size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
@@ -0,0 +1,215 @@
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "GAStarCPU.h" // StepBarrier
+#include "HeuristicCache.h"
+
+// BFS levels with fewer locations are expanded by one thread
+#define PARALLEL_FRONTIER_SIZE 4096
+
+
+HeuristicCache::HeuristicCache(const Instance& instance, int max_memory_mb, int num_of_threads,
+	const string& directory):
+	instance(instance), num_of_threads(max(num_of_threads, 1)), directory(directory)
+{
+	capacity = ((size_t)max(max_memory_mb, 0) << 20) / ((size_t)instance.map_size * sizeof(int));
+	// the hash of the map, mixed with the tile size on which the location ids of the tables depend
+	map_hash = (instance.getMapHash() ^ (uint64_t)instance.tile_shift) * 1099511628211ull;
+}
+
+
+shared_ptr<const int> HeuristicCache::get(int goal)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	auto it = tables.find(goal);
+	if (it != tables.end())
+	{
+		num_of_hits++;
+		goals.splice(goals.begin(), goals, it->second.position);
+		return it->second.distances;
+	}
+	if (capacity == 0)
+		return nullptr;
+	auto pending_it = pending.find(goal);
+	if (pending_it != pending.end())
+	{ // another thread is loading or computing this table
+		num_of_hits++;
+		auto table = pending_it->second;
+		guard.unlock();
+		return table.get();
+	}
+	num_of_misses++;
+	std::promise< shared_ptr<const int> > promise;
+	pending[goal] = promise.get_future().share();
+	guard.unlock();
+
+	shared_ptr<const int> distances = directory.empty() ? nullptr : loadTable(goal);
+	bool loaded = distances != nullptr;
+	double runtime = 0;
+	if (!loaded)
+	{
+		Timer timer;
+		auto table = std::make_shared< vector<int> >(instance.map_size);
+		computeTable(goal, table->data());
+		runtime = timer.elapsed();
+		if (!directory.empty() && !saveTable(goal, table->data()))
+			cerr << "Fail to save the heuristic table to " << getFileName(goal) << endl;
+		distances = shared_ptr<const int>(table, table->data());
+	}
+	promise.set_value(distances);
+
+	guard.lock();
+	pending.erase(goal);
+	if (loaded)
+		num_of_loads++;
+	computation_time += runtime;
+	if (tables.size() >= capacity)
+	{
+		tables.erase(goals.back());
+		goals.pop_back();
+		num_of_evictions++;
+	}
+	goals.push_front(goal);
+	tables[goal] = {distances, goals.begin()};
+	return distances;
+}
+
+
+void HeuristicCache::computeTable(int goal, int* distances) const
+{
+	std::fill(distances, distances + instance.map_size, MAX_COST);
+	size_t num_of_words = GridMap::getNumOfWords(instance.map_size);
+	std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[num_of_words]);
+	for (size_t i = 0; i < num_of_words; i++)
+		visited[i].store(0, std::memory_order_relaxed);
+	vector<int> frontier{goal};
+	distances[goal] = 0;
+	visited[goal >> 6].store((uint64_t)1 << (goal & 63), std::memory_order_relaxed);
+	vector< vector<int> > next(num_of_threads);
+	// expand frontier[begin..end) into next[thread]; a location is claimed by the thread that sets its visited bit
+	auto expand = [&](int thread, size_t begin, size_t end, int distance, bool parallel)
+	{
+		next[thread].clear();
+		for (size_t i = begin; i < end; i++)
+		{
+			int neighbors[4];
+			int num_of_neighbors = instance.getNeighbors(frontier[i], neighbors);
+			for (int j = 0; j < num_of_neighbors; j++)
+			{
+				auto& word = visited[neighbors[j] >> 6];
+				uint64_t bit = (uint64_t)1 << (neighbors[j] & 63);
+				if (word.load(std::memory_order_relaxed) & bit)
+					continue;
+				if (!parallel)
+					word.store(word.load(std::memory_order_relaxed) | bit, std::memory_order_relaxed);
+				else if (word.fetch_or(bit, std::memory_order_relaxed) & bit)
+					continue; // claimed by another thread
+				distances[neighbors[j]] = distance;
+				next[thread].push_back(neighbors[j]);
+			}
+		}
+	};
+	// the workers are started at the first large level and then expand their share of every large level, between two
+	// barrier steps: one that publishes the level and one that waits for their successors
+	vector<std::thread> workers;
+	StepBarrier barrier(num_of_threads);
+	int distance = 0;
+	bool done = false;
+	auto work = [&](int thread)
+	{
+		while (true)
+		{
+			barrier.wait();
+			if (done)
+				return;
+			expand(thread, frontier.size() * thread / num_of_threads,
+				frontier.size() * (thread + 1) / num_of_threads, distance, true);
+			barrier.wait();
+		}
+	};
+	for (distance = 1; !frontier.empty(); distance++)
+	{
+		if (num_of_threads == 1 || frontier.size() < PARALLEL_FRONTIER_SIZE)
+		{
+			expand(0, 0, frontier.size(), distance, false);
+			frontier.swap(next[0]);
+			continue;
+		}
+		for (int i = (int)workers.size() + 1; i < num_of_threads; i++)
+			workers.emplace_back(work, i);
+		barrier.wait();
+		expand(0, 0, frontier.size() / num_of_threads, distance, true);
+		barrier.wait();
+		frontier.swap(next[0]);
+		for (int i = 1; i < num_of_threads; i++)
+			frontier.insert(frontier.end(), next[i].begin(), next[i].end());
+	}
+	if (!workers.empty())
+	{
+		done = true;
+		barrier.wait();
+		for (auto& worker : workers)
+			worker.join();
+	}
+}
+
+
+string HeuristicCache::getFileName(int goal) const
+{
+	char name[64];
+	snprintf(name, sizeof(name), "/pastar_%016llx_%d_%d.dist", (unsigned long long)map_hash,
+		instance.getRowCoordinate(goal), instance.getColCoordinate(goal));
+	return directory + name;
+}
+
+
+shared_ptr<const int> HeuristicCache::loadTable(int goal) const
+{
+	int fd = open(getFileName(goal).c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	char header[HEURISTIC_TABLE_HEADER_SIZE];
+	int32_t fields[4];
+	uint64_t hash;
+	struct stat st;
+	size_t length = HEURISTIC_TABLE_HEADER_SIZE + (size_t)instance.map_size * sizeof(int32_t);
+	bool valid = read(fd, header, HEURISTIC_TABLE_HEADER_SIZE) == HEURISTIC_TABLE_HEADER_SIZE &&
+		memcmp(header, HEURISTIC_TABLE_MAGIC, 8) == 0 && fstat(fd, &st) == 0 && (size_t)st.st_size >= length;
+	if (valid)
+	{
+		memcpy(fields, header + 8, sizeof(fields));
+		memcpy(&hash, header + 24, sizeof(hash));
+		valid = fields[0] == instance.num_of_rows && fields[1] == instance.num_of_cols &&
+			fields[2] == 1 << instance.tile_shift &&
+			fields[3] == instance.getRowCoordinate(goal) * instance.num_of_cols + instance.getColCoordinate(goal) &&
+			hash == map_hash;
+	}
+	void* addr = valid ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (addr == MAP_FAILED)
+		return nullptr;
+	shared_ptr<const void> mapping(addr, [length](const void* p) { munmap(const_cast<void*>(p), length); });
+	return shared_ptr<const int>(mapping,
+		reinterpret_cast<const int*>(static_cast<const char*>(addr) + HEURISTIC_TABLE_HEADER_SIZE));
+}
+
+
+bool HeuristicCache::saveTable(int goal, const int* distances) const
+{
+	ofstream output(getFileName(goal), std::ios::binary);
+	if (!output.is_open())
+		return false;
+	char header[HEURISTIC_TABLE_HEADER_SIZE] = {};
+	int32_t fields[4] = {instance.num_of_rows, instance.num_of_cols, 1 << instance.tile_shift,
+		instance.getRowCoordinate(goal) * instance.num_of_cols + instance.getColCoordinate(goal)};
+	memcpy(header, HEURISTIC_TABLE_MAGIC, 8);
+	memcpy(header + 8, fields, sizeof(fields));
+	memcpy(header + 24, &map_hash, sizeof(map_hash));
+	output.write(header, HEURISTIC_TABLE_HEADER_SIZE);
+	output.write(reinterpret_cast<const char*>(distances), (size_t)instance.map_size * sizeof(int));
+	return output.good();
+}
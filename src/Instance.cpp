@@ -2,14 +2,19 @@
 #include <algorithm>    // std::shuffle
 #include <random>      // std::default_random_engine
 #include <chrono>       // std::chrono::system_clock
+#include <cstring>
 #include"Instance.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 int RANDOM_WALK_STEPS = 100000;
 
 Instance::Instance(const string& map_fname, const string& agent_fname, 
-	int num_of_agents, int num_of_rows, int num_of_cols, int num_of_obstacles, int warehouse_width):
+	int num_of_agents, int num_of_rows, int num_of_cols, int num_of_obstacles, int warehouse_width, int tile_size):
 	map_fname(map_fname), agent_fname(agent_fname), num_of_agents(num_of_agents)
 {
+	setTileSize(tile_size);
 	bool succ = loadMap();
 	if (!succ)
 	{
@@ -26,21 +31,103 @@ Instance::Instance(const string& map_fname, const string& agent_fname,
 		}
 	}
 
-	succ = loadAgents();
-	if (!succ)
+	if (!agent_fname.empty()) // otherwise, a map without agents, whose queries come later
 	{
-		if (num_of_agents > 0)
-		{
-			generateRandomAgents(warehouse_width);
-			saveAgents();
-		}
-		else
+		succ = loadAgents();
+		if (!succ)
 		{
-			cerr << "Agent file " << agent_fname << " not found." << endl;
-			exit(-1);
+			if (num_of_agents > 0)
+			{
+				generateRandomAgents(warehouse_width);
+				saveAgents();
+			}
+			else
+			{
+				cerr << "Agent file " << agent_fname << " not found." << endl;
+				exit(-1);
+			}
 		}
 	}
 
+	map_index.build(*this);
+}
+
+
+Instance::Instance(int num_of_rows, int num_of_cols, const uint8_t* obstacles, int tile_size):
+	num_of_cols(num_of_cols), num_of_rows(num_of_rows), num_of_agents(0)
+{
+	setTileSize(tile_size);
+	setLayout();
+	my_map.resize(map_size, true);
+	for (int i = 0; i < num_of_rows; i++)
+		for (int j = 0; j < num_of_cols; j++)
+			my_map.set(linearizeCoordinate(i, j), obstacles[(size_t)i * num_of_cols + j] != 0);
+	map_index.build(*this);
+}
+
+
+// header (#rows, #cols, tile_shift and #agents as int32, padded to 8 bytes), the map bits, the start and goal locations
+// (int32 each, padded to 8 bytes), then the map index
+#define SHARED_INSTANCE_HEADER_SIZE 16
+
+static size_t getSharedAgentsSize(int num_of_agents)
+{
+	return ((size_t)num_of_agents * 2 * sizeof(int32_t) + 7) / 8 * 8;
+}
+
+
+Instance::Instance(const char* shared, shared_ptr<const void> owner)
+{
+	int32_t header[4];
+	memcpy(header, shared, sizeof(header));
+	num_of_rows = header[0];
+	num_of_cols = header[1];
+	num_of_agents = header[3];
+	setTileSize(1 << header[2]);
+	setLayout();
+	shared += SHARED_INSTANCE_HEADER_SIZE;
+	my_map.attach(reinterpret_cast<const uint64_t*>(shared), map_size, owner);
+	shared += GridMap::getNumOfWords(map_size) * sizeof(uint64_t);
+	const int32_t* agents = reinterpret_cast<const int32_t*>(shared);
+	start_locations.assign(agents, agents + num_of_agents);
+	goal_locations.assign(agents + num_of_agents, agents + 2 * num_of_agents);
+	shared += getSharedAgentsSize(num_of_agents);
+	map_index.attach(shared, owner);
+}
+
+
+size_t Instance::getSharedSize() const
+{
+	return SHARED_INSTANCE_HEADER_SIZE + GridMap::getNumOfWords(map_size) * sizeof(uint64_t) +
+		getSharedAgentsSize((int)start_locations.size()) + map_index.getSharedSize();
+}
+
+
+void Instance::copyToShared(char* shared) const
+{
+	int32_t header[4] = {num_of_rows, num_of_cols, tile_shift, (int32_t)start_locations.size()};
+	memcpy(shared, header, sizeof(header));
+	shared += SHARED_INSTANCE_HEADER_SIZE;
+	memcpy(shared, my_map.data(), GridMap::getNumOfWords(map_size) * sizeof(uint64_t));
+	shared += GridMap::getNumOfWords(map_size) * sizeof(uint64_t);
+	vector<int32_t> agents(start_locations.begin(), start_locations.end());
+	agents.insert(agents.end(), goal_locations.begin(), goal_locations.end());
+	memcpy(shared, agents.data(), agents.size() * sizeof(int32_t));
+	shared += getSharedAgentsSize((int)start_locations.size());
+	map_index.copyToShared(shared);
+}
+
+
+void Instance::setTileSize(int tile_size)
+{
+	while ((1 << tile_shift) < tile_size)
+		tile_shift++;
+	if ((1 << tile_shift) != tile_size)
+	{
+		cerr << "The tile size " << tile_size << " is not a power of two." << endl;
+		exit(-1);
+	}
+	tile_mask = (1 << tile_shift) - 1;
 }
 
 
@@ -149,7 +236,7 @@ bool Instance::addObstacle(int obstacle)
 {
 	if (my_map[obstacle])
 		return false;
-	my_map[obstacle] = true;
+	my_map.set(obstacle, true);
 	int obstacle_x = getRowCoordinate(obstacle);
 	int obstacle_y = getColCoordinate(obstacle);
 	int x[4] = { obstacle_x, obstacle_x + 1, obstacle_x, obstacle_x - 1 };
@@ -173,7 +260,7 @@ bool Instance::addObstacle(int obstacle)
 		}
 		else
 		{
-			my_map[obstacle] = false;
+			my_map.set(obstacle, false);
 			return false;
 		}
 	}
@@ -208,8 +295,11 @@ void Instance::generateConnectedRandomGrid(int rows, int cols, int obstacles)
 	int i, j;
 	num_of_rows = rows + 2;
 	num_of_cols = cols + 2;
-	map_size = num_of_rows * num_of_cols;
-	my_map.resize(map_size, false);
+	setLayout();
+	my_map.resize(map_size, true);
+	for (i = 0; i < num_of_rows; i++)
+		for (j = 0; j < num_of_cols; j++)
+			my_map.set(linearizeCoordinate(i, j), false);
 	// Possible moves [WAIT, NORTH, EAST, SOUTH, WEST]
 	/*moves_offset[Instance::valid_moves_t::WAIT_MOVE] = 0;
 	moves_offset[Instance::valid_moves_t::NORTH] = -num_of_cols;
@@ -220,16 +310,16 @@ void Instance::generateConnectedRandomGrid(int rows, int cols, int obstacles)
 	// add padding
 	i = 0;
 	for (j = 0; j<num_of_cols; j++)
-		my_map[linearizeCoordinate(i, j)] = true;
+		my_map.set(linearizeCoordinate(i, j), true);
 	i = num_of_rows - 1;
 	for (j = 0; j<num_of_cols; j++)
-		my_map[linearizeCoordinate(i, j)] = true;
+		my_map.set(linearizeCoordinate(i, j), true);
 	j = 0;
 	for (i = 0; i<num_of_rows; i++)
-		my_map[linearizeCoordinate(i, j)] = true;
+		my_map.set(linearizeCoordinate(i, j), true);
 	j = num_of_cols - 1;
 	for (i = 0; i<num_of_rows; i++)
-		my_map[linearizeCoordinate(i, j)] = true;
+		my_map.set(linearizeCoordinate(i, j), true);
 
 	// add obstacles uniformly at random
 	i = 0;
@@ -244,16 +334,52 @@ void Instance::generateConnectedRandomGrid(int rows, int cols, int obstacles)
 	}
 }
 
+void Instance::setLayout()
+{
+	int tile_size = 1 << tile_shift;
+	num_of_tile_cols = (num_of_cols + tile_mask) >> tile_shift;
+	map_size = ((num_of_rows + tile_mask) >> tile_shift) * num_of_tile_cols * tile_size * tile_size;
+	inner_tile_offsets[RIGHT] = 1;
+	inner_tile_offsets[DOWN] = tile_size;
+	cross_tile_offsets[RIGHT] = tile_size * tile_size - tile_mask;
+	cross_tile_offsets[DOWN] = num_of_tile_cols * tile_size * tile_size - tile_mask * tile_size;
+	for (int direction = LEFT; direction < DIRECTION_COUNT; direction += 2)
+	{
+		inner_tile_offsets[direction] = -inner_tile_offsets[direction - 1];
+		cross_tile_offsets[direction] = -cross_tile_offsets[direction - 1];
+	}
+}
+
 bool Instance::loadMap()
 {
 	using namespace boost;
 	using namespace std;
+	GridMap row_major;
+	if (loadBinaryMap(map_fname, num_of_rows, num_of_cols, row_major))
+	{
+		setLayout();
+		if (tile_shift == 0)
+			my_map = row_major; // memory-mapped, read-only
+		else
+		{
+			my_map.resize(map_size, true);
+			for (int i = 0; i < num_of_rows; i++)
+				for (int j = 0; j < num_of_cols; j++)
+					my_map.set(linearizeCoordinate(i, j), row_major[i * num_of_cols + j]);
+		}
+		return true;
+	}
 	ifstream myfile(map_fname.c_str());
 	if (!myfile.is_open())
 		return false;
 	string line;
 	tokenizer< char_separator<char> >::iterator beg;
 	getline(myfile, line);
+	if (line.compare(0, 8, BINARY_MAP_MAGIC) == 0) // rejected by loadBinaryMap
+	{
+		cerr << "Binary map file " << map_fname << " is corrupted." << endl;
+		return false;
+	}
 	if (line[0] == 't') // Nathan's benchmark
 	{
 		char_separator<char> sep(" ");
@@ -278,13 +404,13 @@ bool Instance::loadMap()
 		beg++;
 		num_of_cols = atoi((*beg).c_str()); // read number of cols
 	}
-	map_size = num_of_cols * num_of_rows;
-	my_map.resize(map_size, false);
+	setLayout();
+	my_map.resize(map_size, true);
 	// read map (and start/goal locations)
 	for (int i = 0; i < num_of_rows; i++) {
 		getline(myfile, line);
 		for (int j = 0; j < num_of_cols; j++) {
-			my_map[linearizeCoordinate(i, j)] = (line[j] != '.');
+			my_map.set(linearizeCoordinate(i, j), line[j] != '.');
 		}
 	}
 	myfile.close();
@@ -299,6 +425,45 @@ bool Instance::loadMap()
 }
 
 
+bool Instance::saveBinaryMap(const string& fname) const
+{
+	if (tile_shift == 0)
+		return ::saveBinaryMap(fname, num_of_rows, num_of_cols, my_map);
+	GridMap row_major;
+	row_major.resize(num_of_rows * num_of_cols);
+	for (int i = 0; i < num_of_rows; i++)
+		for (int j = 0; j < num_of_cols; j++)
+			row_major.set(i * num_of_cols + j, my_map[linearizeCoordinate(i, j)]);
+	return ::saveBinaryMap(fname, num_of_rows, num_of_cols, row_major);
+}
+
+
+uint64_t Instance::getMapHash() const
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&](uint64_t value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+	mix(num_of_rows);
+	mix(num_of_cols);
+	uint64_t word = 0;
+	int size = num_of_rows * num_of_cols;
+	for (int i = 0; i < size; i++)
+	{
+		if (my_map[linearizeCoordinate(i / num_of_cols, i % num_of_cols)])
+			word |= 1ull << (i % 64);
+		if (i % 64 == 63 || i == size - 1)
+		{
+			mix(word);
+			word = 0;
+		}
+	}
+	return hash;
+}
+
+
 void Instance::printMap() const
 {
 	for (int i = 0; i< num_of_rows; i++)
@@ -445,12 +610,111 @@ void Instance::saveAgents() const
 
 list<int> Instance::getNeighbors(int curr) const
 {
-	list<int> neighbors;
-	int candidates[4] = {curr + 1, curr - 1, curr + num_of_cols, curr - num_of_cols};
-	for (int next : candidates)
+	int candidates[4];
+	int num_of_neighbors = getNeighbors(curr, candidates);
+	return list<int>(candidates, candidates + num_of_neighbors);
+}
+
+int Instance::getNeighbors(int curr, int neighbors[4]) const
+{
+	int row = getRowCoordinate(curr), col = getColCoordinate(curr);
+	bool inside[4] = {col < num_of_cols - 1, col > 0, row < num_of_rows - 1, row > 0};
+	int num_of_neighbors = 0;
+	for (int direction = 0; direction < DIRECTION_COUNT; direction++)
 	{
-		if (validMove(curr, next))
-			neighbors.emplace_back(next);
+		if (!inside[direction])
+			continue;
+		int next = getAdjacent(curr, direction);
+		if (!my_map[next])
+			neighbors[num_of_neighbors++] = next;
 	}
-	return neighbors;
+	return num_of_neighbors;
+}
+
+int Instance::getSuccessors(int curr, int goal, int neighbors[4], int h_vals[4]) const
+{
+	int row = getRowCoordinate(curr), col = getColCoordinate(curr);
+	int goal_row = getRowCoordinate(goal), goal_col = getColCoordinate(goal);
+	int candidates[4], dists[4], inside;
+#ifdef __SSE2__
+	// lanes: right, left, down, up
+	__m128i rows = _mm_add_epi32(_mm_set1_epi32(row), _mm_setr_epi32(0, 0, 1, -1));
+	__m128i cols = _mm_add_epi32(_mm_set1_epi32(col), _mm_setr_epi32(1, -1, 0, 0));
+	__m128i in_rows = _mm_and_si128(_mm_cmpgt_epi32(rows, _mm_set1_epi32(-1)),
+		_mm_cmplt_epi32(rows, _mm_set1_epi32(num_of_rows)));
+	__m128i in_cols = _mm_and_si128(_mm_cmpgt_epi32(cols, _mm_set1_epi32(-1)),
+		_mm_cmplt_epi32(cols, _mm_set1_epi32(num_of_cols)));
+	inside = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(in_rows, in_cols)));
+	__m128i dr = _mm_sub_epi32(rows, _mm_set1_epi32(goal_row));
+	__m128i dc = _mm_sub_epi32(cols, _mm_set1_epi32(goal_col));
+	__m128i sign_r = _mm_srai_epi32(dr, 31), sign_c = _mm_srai_epi32(dc, 31);
+	__m128i h = _mm_add_epi32(_mm_sub_epi32(_mm_xor_si128(dr, sign_r), sign_r),
+		_mm_sub_epi32(_mm_xor_si128(dc, sign_c), sign_c)); // |dr| + |dc|
+	_mm_storeu_si128((__m128i*)dists, h);
+	// the offset of each move depends on whether it leaves the tile of curr (see getAdjacent)
+	int col_in_tile = curr & tile_mask, row_in_tile = (curr >> tile_shift) & tile_mask;
+	__m128i cross = _mm_cmpeq_epi32(_mm_setr_epi32(col_in_tile, col_in_tile, row_in_tile, row_in_tile),
+		_mm_setr_epi32(tile_mask, 0, tile_mask, 0));
+	__m128i offsets = _mm_or_si128(
+		_mm_and_si128(cross, _mm_loadu_si128((const __m128i*)cross_tile_offsets)),
+		_mm_andnot_si128(cross, _mm_loadu_si128((const __m128i*)inner_tile_offsets)));
+	_mm_storeu_si128((__m128i*)candidates, _mm_add_epi32(_mm_set1_epi32(curr), offsets));
+#else
+	int rows[4] = {row, row, row + 1, row - 1};
+	int cols[4] = {col + 1, col - 1, col, col};
+	inside = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (rows[i] >= 0 && rows[i] < num_of_rows && cols[i] >= 0 && cols[i] < num_of_cols)
+			inside |= 1 << i;
+		dists[i] = abs(rows[i] - goal_row) + abs(cols[i] - goal_col);
+		candidates[i] = getAdjacent(curr, i);
+	}
+#endif
+	int num_of_neighbors = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if ((inside >> i & 1) && !my_map[candidates[i]])
+		{
+			neighbors[num_of_neighbors] = candidates[i];
+			h_vals[num_of_neighbors++] = dists[i];
+		}
+	}
+	return num_of_neighbors;
+}
+
+bool Instance::getMonotonePath(int from, int to, vector<int>& path) const
+{
+	int r0 = getRowCoordinate(from), c0 = getColCoordinate(from);
+	int r1 = getRowCoordinate(to), c1 = getColCoordinate(to);
+	int dr = r1 >= r0 ? 1 : -1, dc = c1 >= c0 ? 1 : -1;
+	int h = abs(r1 - r0) + 1, w = abs(c1 - c0) + 1;
+	// reach[i * w + j] is true if cell (r0 + i * dr, c0 + j * dc) can be reached from "from" by a monotone path
+	vector<bool> reach(h * w, false);
+	for (int i = 0; i < h; i++)
+	{
+		for (int j = 0; j < w; j++)
+		{
+			if (my_map[linearizeCoordinate(r0 + i * dr, c0 + j * dc)])
+				continue;
+			reach[i * w + j] = (i == 0 && j == 0) ||
+				(i > 0 && reach[(i - 1) * w + j]) || (j > 0 && reach[i * w + j - 1]);
+		}
+	}
+	if (!reach[h * w - 1])
+		return false;
+
+	// trace back from "to"
+	size_t offset = path.size();
+	int i = h - 1, j = w - 1;
+	while (i > 0 || j > 0)
+	{
+		path.push_back(linearizeCoordinate(r0 + i * dr, c0 + j * dc));
+		if (i > 0 && reach[(i - 1) * w + j])
+			i--;
+		else
+			j--;
+	}
+	std::reverse(path.begin() + offset, path.end());
+	return true;
 }
\ No newline at end of file
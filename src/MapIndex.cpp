@@ -0,0 +1,218 @@
+#include <cstring>
+#include "MapIndex.h"
+#include "Instance.h"
+
+const int MapIndex::ALL;
+const int MapIndex::UNREACHABLE;
+
+
+MapIndex& MapIndex::operator=(const MapIndex& other)
+{
+	num_of_components = other.num_of_components;
+	num_of_blocks = other.num_of_blocks;
+	num_of_articulations = other.num_of_articulations;
+	preprocessing_time = other.preprocessing_time;
+	num_of_nodes = other.num_of_nodes;
+	num_of_cells = other.num_of_cells;
+	node_storage = other.node_storage;
+	cell_node_storage = other.cell_node_storage;
+	owner = other.owner;
+	nodes = owner != nullptr ? other.nodes : node_storage.data();
+	cell_nodes = owner != nullptr ? other.cell_nodes : (other.empty() ? nullptr : cell_node_storage.data());
+	return *this;
+}
+
+
+// Finds the blocks and articulation cells with an iterative version of the DFS of Hopcroft and Tarjan, then roots the
+// block-cut tree of each component at the block (or articulation cell) of the first cell of the DFS.
+void MapIndex::build(const Instance& instance)
+{
+	Timer timer;
+	node_storage.clear();
+	cell_node_storage.assign(instance.map_size, -1);
+	num_of_components = num_of_blocks = num_of_articulations = 0;
+
+	vector<int> disc(instance.map_size, -1), low(instance.map_size);
+	vector<int> owner(instance.map_size, -1); // the block in which the cell was popped (-1 for the DFS roots)
+	vector<int> num_of_tops(instance.map_size, 0); // number of blocks whose top (closest cell to the DFS root) it is
+	vector<int> block_tops;
+	vector<pair<int, int>> frames; // (cell, index of its next neighbor)
+	vector<int> stack;
+	int time = 0;
+	for (int root = 0; root < instance.map_size; root++)
+	{
+		if (instance.isObstacle(root) || disc[root] >= 0)
+			continue;
+		disc[root] = low[root] = time++;
+		frames.emplace_back(root, 0);
+		stack.push_back(root);
+		while (!frames.empty())
+		{
+			int curr = frames.back().first;
+			int neighbors[4];
+			int num_of_neighbors = instance.getNeighbors(curr, neighbors);
+			if (frames.back().second < num_of_neighbors)
+			{
+				int next = neighbors[frames.back().second++];
+				if (disc[next] < 0)
+				{
+					disc[next] = low[next] = time++;
+					frames.emplace_back(next, 0);
+					stack.push_back(next);
+				}
+				else
+					low[curr] = min(low[curr], disc[next]);
+				continue;
+			}
+			frames.pop_back();
+			if (frames.empty())
+				break;
+			int parent = frames.back().first;
+			low[parent] = min(low[parent], low[curr]);
+			if (low[curr] >= disc[parent]) // parent separates the subtree of curr from the rest: a new block
+			{
+				int cell;
+				do
+				{
+					cell = stack.back();
+					stack.pop_back();
+					owner[cell] = num_of_blocks;
+				} while (cell != curr);
+				block_tops.push_back(parent);
+				num_of_tops[parent]++;
+				num_of_blocks++;
+			}
+		}
+		stack.clear();
+		if (num_of_tops[root] == 0) // an isolated cell
+		{
+			owner[root] = num_of_blocks++;
+			block_tops.push_back(-1);
+		}
+	}
+
+	// tree nodes: the blocks, then the articulation cells, which are the tops of blocks except DFS roots with one child
+	node_storage.resize(num_of_blocks);
+	for (int loc = 0; loc < instance.map_size; loc++)
+	{
+		if (num_of_tops[loc] > (owner[loc] < 0 ? 1 : 0))
+		{
+			cell_node_storage[loc] = (int)node_storage.size();
+			node_storage.push_back({owner[loc], 0, 0, 0, true});
+			num_of_articulations++;
+		}
+	}
+	for (int block = 0; block < num_of_blocks; block++)
+	{
+		int top = block_tops[block];
+		node_storage[block] = {top >= 0 ? cell_node_storage[top] : -1, 0, 0, 0, false};
+		if (top >= 0 && cell_node_storage[top] < 0) // the DFS root of a component with a single block
+			cell_node_storage[top] = block;
+	}
+	for (int loc = 0; loc < instance.map_size; loc++)
+	{
+		if (cell_node_storage[loc] < 0 && owner[loc] >= 0)
+			cell_node_storage[loc] = owner[loc];
+	}
+
+	// preorder numbers of the forest
+	vector<int> num_of_children(node_storage.size() + 1, 0); // indexed by parent + 1, so that the roots come first
+	for (const auto& node : node_storage)
+		num_of_children[node.parent + 1]++;
+	vector<int> offsets(node_storage.size() + 2, 0);
+	for (size_t i = 0; i <= node_storage.size(); i++)
+		offsets[i + 1] = offsets[i] + num_of_children[i];
+	vector<int> children(node_storage.size()); // the children of node i are children[offsets[i + 1]..offsets[i + 2])
+	vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (int i = 0; i < (int)node_storage.size(); i++)
+		children[fill[node_storage[i].parent + 1]++] = i;
+	int order = 0;
+	vector<pair<int, int>> dfs; // (node, index of its next child)
+	for (int r = offsets[0]; r < offsets[1]; r++)
+	{
+		dfs.emplace_back(children[r], offsets[children[r] + 1]);
+		node_storage[children[r]].first = order++;
+		while (!dfs.empty())
+		{
+			int node = dfs.back().first;
+			node_storage[node].component = num_of_components;
+			if (dfs.back().second < offsets[node + 2])
+			{
+				int child = children[dfs.back().second++];
+				node_storage[child].first = order++;
+				dfs.emplace_back(child, offsets[child + 1]);
+				continue;
+			}
+			node_storage[node].last = order - 1;
+			dfs.pop_back();
+		}
+		num_of_components++;
+	}
+	nodes = node_storage.data();
+	cell_nodes = cell_node_storage.data();
+	num_of_nodes = (int)node_storage.size();
+	num_of_cells = instance.map_size;
+	this->owner = nullptr;
+	preprocessing_time = timer.elapsed();
+}
+
+
+MapIndex::Corridor MapIndex::getCorridor(int start, int goal) const
+{
+	Corridor corridor;
+	if (empty())
+		return corridor;
+	corridor.source = cell_nodes[start];
+	corridor.target = cell_nodes[goal];
+	if (corridor.source < 0 || corridor.target < 0) // an obstacle only reaches itself
+	{
+		corridor.top = start == goal ? ALL : UNREACHABLE;
+		return corridor;
+	}
+	if (nodes[corridor.source].component != nodes[corridor.target].component)
+	{
+		corridor.top = UNREACHABLE;
+		return corridor;
+	}
+	corridor.top = corridor.source;
+	while (!isAncestor(corridor.top, corridor.target))
+		corridor.top = nodes[corridor.top].parent;
+	return corridor;
+}
+
+
+// header (#components, #blocks, #articulations, #tree nodes and #cells as int32, padded to 8 bytes), the tree nodes,
+// then the tree node of each cell
+size_t MapIndex::getSharedSize() const
+{
+	return MAP_INDEX_HEADER_SIZE + (size_t)num_of_nodes * sizeof(TreeNode) + (size_t)num_of_cells * sizeof(int);
+}
+
+
+void MapIndex::copyToShared(char* shared) const
+{
+	int32_t header[MAP_INDEX_HEADER_SIZE / sizeof(int32_t)] = {num_of_components, num_of_blocks, num_of_articulations,
+		num_of_nodes, num_of_cells};
+	memcpy(shared, header, sizeof(header));
+	memcpy(shared + MAP_INDEX_HEADER_SIZE, nodes, (size_t)num_of_nodes * sizeof(TreeNode));
+	memcpy(shared + MAP_INDEX_HEADER_SIZE + (size_t)num_of_nodes * sizeof(TreeNode), cell_nodes,
+		(size_t)num_of_cells * sizeof(int));
+}
+
+
+void MapIndex::attach(const char* shared, shared_ptr<const void> owner)
+{
+	int32_t header[MAP_INDEX_HEADER_SIZE / sizeof(int32_t)];
+	memcpy(header, shared, sizeof(header));
+	num_of_components = header[0];
+	num_of_blocks = header[1];
+	num_of_articulations = header[2];
+	num_of_nodes = header[3];
+	num_of_cells = header[4];
+	node_storage.clear();
+	cell_node_storage.clear();
+	nodes = reinterpret_cast<const TreeNode*>(shared + MAP_INDEX_HEADER_SIZE);
+	cell_nodes = num_of_cells > 0 ?
+		reinterpret_cast<const int*>(shared + MAP_INDEX_HEADER_SIZE + (size_t)num_of_nodes * sizeof(TreeNode)) : nullptr;
+	this->owner = owner;
+}
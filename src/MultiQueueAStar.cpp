@@ -0,0 +1,226 @@
+#include <thread>
+#include "MultiQueueAStar.h"
+
+#define EMPTY_STATE (((uint64_t)MAX_COST << 32) | 0xffffffffu)
+// expansions of thread 0 between two samples of the OPEN size
+#define OPEN_SIZE_SAMPLE_INTERVAL 1024
+
+
+static inline uint64_t nextRandom(uint64_t& seed) // xorshift64
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed;
+}
+
+
+MultiQueueAStar::MultiQueueAStar(const Instance& instance, int agent, int num_of_threads, int queues_per_thread):
+	SingleAgentSolver(instance, agent), num_of_threads(max(num_of_threads, 1)),
+	num_of_queues(max(num_of_threads, 1) * max(queues_per_thread, 1))
+{
+	nproc = this->num_of_threads;
+}
+
+
+Path MultiQueueAStar::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path MultiQueueAStar::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 1;
+	num_allocated = 0;
+	peak_open_size = 1;
+
+	queues.reset(new Queue[num_of_queues]);
+	for (int i = 0; i < num_of_queues; i++)
+	{
+		queues[i].min_f_val = MAX_COST;
+		queues[i].size = 0;
+	}
+	states.reset(new std::atomic<uint64_t>[instance.map_size]);
+	for (int loc = 0; loc < instance.map_size; loc++)
+		states[loc].store(EMPTY_STATE, std::memory_order_relaxed);
+	num_of_busy_threads = 0;
+	num_of_operations = 0;
+	done = false;
+
+	improve(start_location, 0, -1);
+	corridor = instance.map_index.getCorridor(start_location, goal_location);
+	if (start_location != goal_location && corridor.isReachable())
+	{
+		uint64_t seed = trial_idx + 1;
+		push({compute_heuristic(start_location, goal_location), 0, start_location}, seed);
+	}
+
+	vector<uint64_t> expanded(num_of_threads, 0), generated(num_of_threads, 0);
+	vector<std::thread> threads;
+	for (int i = 1; i < num_of_threads; i++)
+		threads.emplace_back(&MultiQueueAStar::search, this, i, std::ref(expanded[i]), std::ref(generated[i]));
+	search(0, expanded[0], generated[0]);
+	for (auto& thread : threads)
+		thread.join();
+	for (int i = 0; i < num_of_threads; i++)
+	{
+		num_expanded += expanded[i];
+		num_generated += generated[i];
+	}
+
+	int cost = getGVal(goal_location);
+	if (cost < MAX_COST)
+	{
+		// g-vals strictly decrease along the parents, so this ends at the start location
+		path.resize(cost + 1);
+		int loc = goal_location;
+		for (int t = cost; t >= 0; t--)
+		{
+			path[t] = loc;
+			loc = getParent(loc);
+		}
+	}
+
+	queues.reset();
+	states.reset();
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+void MultiQueueAStar::search(int thread_id, uint64_t& expanded, uint64_t& generated)
+{
+	uint64_t seed = ((uint64_t)trial_idx << 32) + thread_id + 1;
+	Entry curr;
+	while (!done.load(std::memory_order_relaxed))
+	{
+		num_of_busy_threads++;
+		if (!pop(curr, seed))
+		{
+			num_of_busy_threads--;
+			if (!checkTermination())
+				std::this_thread::yield();
+			continue;
+		}
+		if (curr.f_val >= getGVal(goal_location)) // cannot improve the incumbent
+		{
+			num_of_busy_threads--;
+			checkTermination();
+			continue;
+		}
+		if (curr.g_val > getGVal(curr.location)) // a better path to this location has been found
+		{
+			num_of_busy_threads--;
+			continue;
+		}
+
+		expanded++;
+		int next_locations[4], next_h_vals[4];
+		int num_of_neighbors = instance.getSuccessors(curr.location, goal_location, next_locations, next_h_vals);
+		for (int j = 0; j < num_of_neighbors; j++)
+		{
+			int next_location = next_locations[j];
+			int next_g_val = curr.g_val + 1;
+			int next_h_val = goal_distances != nullptr ? goal_distances.get()[next_location] : next_h_vals[j];
+			int next_f_val = next_g_val + next_h_val;
+			if (next_f_val >= getGVal(goal_location) || !instance.map_index.inCorridor(corridor, next_location) ||
+				!improve(next_location, next_g_val, curr.location))
+				continue;
+			if (next_location != goal_location) // the goal becomes the incumbent and is not expanded
+				push({next_f_val, next_g_val, next_location}, seed);
+			generated++;
+		}
+		num_of_busy_threads--;
+
+		if (thread_id == 0 && expanded % OPEN_SIZE_SAMPLE_INTERVAL == 0)
+		{
+			uint64_t open_size = 0;
+			for (int i = 0; i < num_of_queues; i++)
+				open_size += queues[i].size.load(std::memory_order_relaxed);
+			peak_open_size = max(peak_open_size, open_size);
+		}
+	}
+}
+
+
+// pop from the better of two random heaps
+bool MultiQueueAStar::pop(Entry& entry, uint64_t& seed)
+{
+	for (int attempt = 0; attempt < 2 * num_of_queues; attempt++)
+	{
+		int i = nextRandom(seed) % num_of_queues;
+		int j = nextRandom(seed) % num_of_queues;
+		if (queues[j].min_f_val.load(std::memory_order_relaxed) < queues[i].min_f_val.load(std::memory_order_relaxed))
+			i = j;
+		Queue& queue = queues[i];
+		if (queue.min_f_val.load(std::memory_order_relaxed) == MAX_COST || !queue.lock.try_lock())
+			continue;
+		if (queue.heap.empty())
+		{
+			queue.lock.unlock();
+			continue;
+		}
+		entry = queue.heap.top();
+		queue.heap.pop();
+		queue.min_f_val = queue.heap.empty() ? MAX_COST : queue.heap.top().f_val;
+		queue.size--;
+		num_of_operations++;
+		queue.lock.unlock();
+		return true;
+	}
+	return false;
+}
+
+
+void MultiQueueAStar::push(const Entry& entry, uint64_t& seed)
+{
+	while (true)
+	{
+		Queue& queue = queues[nextRandom(seed) % num_of_queues];
+		if (!queue.lock.try_lock())
+			continue;
+		queue.heap.push(entry);
+		queue.min_f_val = queue.heap.top().f_val;
+		queue.size++;
+		num_of_operations++;
+		queue.lock.unlock();
+		return;
+	}
+}
+
+
+bool MultiQueueAStar::improve(int location, int g_val, int parent)
+{
+	uint64_t state = states[location].load();
+	uint64_t new_state = ((uint64_t)g_val << 32) | (uint32_t)parent;
+	while ((int)(state >> 32) > g_val)
+	{
+		if (states[location].compare_exchange_weak(state, new_state))
+			return true;
+	}
+	return false;
+}
+
+
+// The search is over if, at a moment when no thread is expanding, no heap holds an entry with f-val below the
+// incumbent's. Any push or pop during the check invalidates it.
+bool MultiQueueAStar::checkTermination()
+{
+	uint64_t operations = num_of_operations.load();
+	if (num_of_busy_threads.load() > 0)
+		return false;
+	int incumbent = getGVal(goal_location);
+	for (int i = 0; i < num_of_queues; i++)
+	{
+		if (queues[i].min_f_val.load() < incumbent)
+			return false;
+	}
+	if (num_of_operations.load() != operations)
+		return false;
+	done = true;
+	return true;
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "MultiSourceBFS.h"
+
+const int MultiSourceBFS::BATCH_SIZE;
+
+
+void MultiSourceBFS::computeDistances(const vector<int>& sources, const vector<int>& targets, vector<int>& distances)
+{
+	Timer timer;
+	vector<int> target_ids(instance.map_size, -1);
+	vector< pair<int, int> > duplicates; // (column, column of the same location)
+	for (int j = 0; j < (int)targets.size(); j++)
+	{
+		if (target_ids[targets[j]] < 0)
+			target_ids[targets[j]] = j;
+		else
+			duplicates.emplace_back(j, target_ids[targets[j]]);
+	}
+	search(sources, target_ids, (int)targets.size(), distances);
+	for (size_t i = 0; i < sources.size(); i++)
+		for (const auto& duplicate : duplicates)
+			distances[i * targets.size() + duplicate.first] = distances[i * targets.size() + duplicate.second];
+	runtime = timer.elapsed();
+}
+
+
+void MultiSourceBFS::computeDistancesToAll(const vector<int>& sources, vector<int>& distances)
+{
+	Timer timer;
+	vector<int> target_ids(instance.map_size);
+	for (int loc = 0; loc < instance.map_size; loc++)
+		target_ids[loc] = loc;
+	search(sources, target_ids, instance.map_size, distances);
+	runtime = timer.elapsed();
+}
+
+
+void MultiSourceBFS::search(const vector<int>& sources, const vector<int>& target_ids, int num_of_targets,
+	vector<int>& distances) const
+{
+	distances.assign(sources.size() * num_of_targets, MAX_COST);
+	// rows of distances in the Z-order of their sources
+	vector<uint64_t> keys(sources.size());
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		uint64_t row = instance.getRowCoordinate(sources[i]), col = instance.getColCoordinate(sources[i]), key = 0;
+		for (int bit = 0; bit < 32; bit++)
+			key |= ((row >> bit & 1) << (2 * bit + 1)) | ((col >> bit & 1) << (2 * bit));
+		keys[i] = key << 32 | i;
+	}
+	std::sort(keys.begin(), keys.end());
+	vector<int> rows(sources.size());
+	for (size_t i = 0; i < sources.size(); i++)
+		rows[i] = (int)(keys[i] & 0xffffffffu);
+
+	int num_of_batches = ((int)sources.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+	std::atomic<int> next_batch(0);
+	auto worker = [&]()
+	{
+		vector<State> states;
+		for (int batch = next_batch++; batch < num_of_batches; batch = next_batch++)
+		{
+			int first = batch * BATCH_SIZE;
+			searchBatch(sources, &rows[first], min(BATCH_SIZE, (int)sources.size() - first), target_ids,
+				num_of_targets, distances, states);
+		}
+	};
+	vector<std::thread> threads;
+	for (int i = 1; i < min(num_of_threads, num_of_batches); i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+
+void MultiSourceBFS::searchBatch(const vector<int>& sources, const int* rows, int num_of_sources,
+	const vector<int>& target_ids, int num_of_targets, vector<int>& distances, vector<State>& states) const
+{
+	const Mask empty_mask = {};
+	states.assign(instance.map_size, {empty_mask, {empty_mask, empty_mask}});
+	uint64_t num_of_unreached = 0; // (source, target) pairs, to stop once all targets are reached
+	for (int loc = 0; loc < instance.map_size; loc++)
+		if (target_ids[loc] >= 0)
+			num_of_unreached += num_of_sources;
+	auto isEmpty = [](const Mask& mask)
+	{
+		uint64_t any = 0;
+		for (int w = 0; w < MSBFS_MASK_WORDS; w++)
+			any |= mask.words[w];
+		return any == 0;
+	};
+	auto record = [&](int loc, const Mask& reached, int distance)
+	{
+		int target = target_ids[loc];
+		if (target < 0)
+			return;
+		for (int w = 0; w < MSBFS_MASK_WORDS; w++)
+		{
+			for (uint64_t bits = reached.words[w]; bits != 0; bits &= bits - 1)
+			{
+				distances[(size_t)rows[w * 64 + __builtin_ctzll(bits)] * num_of_targets + target] = distance;
+				num_of_unreached--;
+			}
+		}
+	};
+
+	vector<int> frontier, next;
+	int curr = 0; // the frontier masks are visit[curr], and the next ones visit[1 - curr]
+	for (int i = 0; i < num_of_sources; i++)
+	{
+		State& source = states[sources[rows[i]]];
+		if (isEmpty(source.visit[curr]))
+			frontier.push_back(sources[rows[i]]);
+		source.visit[curr].words[i / 64] |= (uint64_t)1 << (i % 64);
+	}
+	for (int loc : frontier)
+	{
+		states[loc].seen = states[loc].visit[curr];
+		record(loc, states[loc].seen, 0);
+	}
+	// a source reaches a location at the first level at which it is added to its seen mask, so the masks are
+	// updated in place and each location is visited once per level, for all its sources
+	for (int distance = 1; !frontier.empty() && num_of_unreached > 0; distance++)
+	{
+		next.clear();
+		for (int loc : frontier)
+		{
+			Mask visit = states[loc].visit[curr];
+			states[loc].visit[curr] = empty_mask;
+			int neighbors[4];
+			int num_of_neighbors = instance.getNeighbors(loc, neighbors);
+			for (int j = 0; j < num_of_neighbors; j++)
+			{
+				State& neighbor = states[neighbors[j]];
+				Mask reached;
+				for (int w = 0; w < MSBFS_MASK_WORDS; w++)
+					reached.words[w] = visit.words[w] & ~neighbor.seen.words[w];
+				if (isEmpty(reached))
+					continue;
+				if (isEmpty(neighbor.visit[1 - curr]))
+					next.push_back(neighbors[j]);
+				for (int w = 0; w < MSBFS_MASK_WORDS; w++)
+				{
+					neighbor.visit[1 - curr].words[w] |= reached.words[w];
+					neighbor.seen.words[w] |= reached.words[w];
+				}
+				record(neighbors[j], reached, distance);
+			}
+		}
+		frontier.swap(next);
+		curr = 1 - curr;
+	}
+}
+
+
+bool saveDistanceMatrix(const string& fileName, int num_of_rows, int num_of_cols, const vector<int>& distances)
+{
+	ofstream output(fileName, std::ios::binary);
+	if (!output.is_open())
+		return false;
+	int32_t dims[2] = {num_of_rows, num_of_cols};
+	output.write(DISTANCE_MATRIX_MAGIC, 8);
+	output.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+	vector<int32_t> row(num_of_cols);
+	for (int i = 0; i < num_of_rows; i++)
+	{
+		for (int j = 0; j < num_of_cols; j++)
+		{
+			int distance = distances[(size_t)i * num_of_cols + j];
+			row[j] = distance < MAX_COST ? distance : -1;
+		}
+		output.write(reinterpret_cast<const char*>(row.data()), num_of_cols * sizeof(int32_t));
+	}
+	return output.good();
+}
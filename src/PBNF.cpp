@@ -0,0 +1,235 @@
+#include <thread>
+#include "PBNF.h"
+
+// nblock acquisitions between two samples of the OPEN size
+#define OPEN_SIZE_SAMPLE_INTERVAL 64
+
+
+PBNF::PBNF(const Instance& instance, int agent, int num_of_threads, int nblock_size, int min_expansions):
+	SingleAgentSolver(instance, agent), num_of_threads(max(num_of_threads, 1)), nblock_size(max(nblock_size, 1)),
+	min_expansions(max(min_expansions, 1))
+{
+	nproc = this->num_of_threads;
+	nblock_rows = (instance.num_of_rows + this->nblock_size - 1) / this->nblock_size;
+	nblock_cols = (instance.num_of_cols + this->nblock_size - 1) / this->nblock_size;
+}
+
+
+Path PBNF::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path PBNF::findSuboptimalPath()
+{
+	Path path;
+	num_expanded = 0;
+	num_generated = 1;
+	num_allocated = 0;
+	peak_open_size = 1;
+	num_of_switches = 0;
+	corridor = instance.map_index.getCorridor(start_location, goal_location);
+	if (!corridor.isReachable())
+	{
+		planned_path = path;
+		path_cost = -1;
+		return path;
+	}
+
+	nblocks.clear();
+	nblocks.resize(nblock_rows * nblock_cols);
+	for (int row = 0; row < nblock_rows; row++)
+	{
+		for (int col = 0; col < nblock_cols; col++)
+		{
+			auto& interference = nblocks[row * nblock_cols + col].interference;
+			for (int r = max(row - 2, 0); r <= min(row + 2, nblock_rows - 1); r++)
+			{
+				for (int c = max(col - 2, 0); c <= min(col + 2, nblock_cols - 1); c++)
+				{
+					if ((r != row || c != col) && abs(r - row) + abs(c - col) <= 2)
+						interference.push_back(r * nblock_cols + c);
+				}
+			}
+		}
+	}
+	free_list.clear();
+	num_in_use = 0;
+	incumbent = start_location == goal_location ? 0 : MAX_COST;
+	num_of_expansions = 0;
+	num_of_generations = 0;
+
+	int h_val = compute_heuristic(start_location, goal_location);
+	auto start = new Node{start_location, 0, h_val, nullptr};
+	NBlock& start_nblock = nblocks[getNBlock(start_location)];
+	start_nblock.nodes[start_location] = start;
+	start_nblock.open.push({h_val, 0, start});
+	updateFreeList(getNBlock(start_location));
+
+	vector<std::thread> threads;
+	for (int i = 1; i < num_of_threads; i++)
+		threads.emplace_back(&PBNF::search, this);
+	search();
+	for (auto& thread : threads)
+		thread.join();
+	num_expanded = num_of_expansions;
+	num_generated += num_of_generations;
+
+	if (incumbent < MAX_COST)
+	{
+		// g-vals strictly decrease along the parents, so this ends at the start node
+		const Node* curr = nblocks[getNBlock(goal_location)].nodes[goal_location];
+		path.resize(curr->g_val + 1);
+		for (; curr != nullptr; curr = curr->parent)
+			path[curr->g_val] = curr->location;
+	}
+
+	for (auto& nblock : nblocks)
+	{
+		num_allocated += nblock.nodes.size();
+		for (auto& entry : nblock.nodes)
+			delete entry.second;
+	}
+	nblocks.clear();
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+void PBNF::search()
+{
+	uint64_t expanded = 0, generated = 0;
+	int curr_nblock = -1;
+	while ((curr_nblock = acquire(curr_nblock)) >= 0)
+	{
+		NBlock& nblock = nblocks[curr_nblock];
+		for (int count = 1; ; count++)
+		{
+			if (getBestFVal(nblock) == MAX_COST)
+				break;
+			Node* curr = nblock.open.top().node;
+			nblock.open.pop();
+			expand(curr, generated);
+			expanded++;
+			if (count % min_expansions == 0 && best_free_f_val.load() < getBestFVal(nblock))
+				break; // a free nblock is better
+		}
+	}
+	num_of_expansions += expanded;
+	num_of_generations += generated;
+}
+
+
+void PBNF::expand(Node* curr, uint64_t& generated)
+{
+	int next_locations[4], next_h_vals[4];
+	int num_of_neighbors = instance.getSuccessors(curr->location, goal_location, next_locations, next_h_vals);
+	for (int j = 0; j < num_of_neighbors; j++)
+	{
+		int next_location = next_locations[j];
+		int next_g_val = curr->g_val + 1;
+		int next_h_val = goal_distances != nullptr ? goal_distances.get()[next_location] : next_h_vals[j];
+		if (next_g_val + next_h_val >= incumbent.load(std::memory_order_relaxed) ||
+			!instance.map_index.inCorridor(corridor, next_location))
+			continue;
+		NBlock& nblock = nblocks[getNBlock(next_location)]; // in the scope of the current nblock
+		Node*& next = nblock.nodes[next_location];
+		if (next == nullptr)
+			next = new Node{next_location, next_g_val, next_h_val, curr};
+		else if (next->g_val > next_g_val)
+		{
+			next->g_val = next_g_val;
+			next->parent = curr;
+		}
+		else
+			continue;
+		generated++;
+		if (next_location == goal_location)
+		{
+			int best = incumbent.load();
+			while (next_g_val < best && !incumbent.compare_exchange_weak(best, next_g_val)) {}
+			continue; // the goal is not expanded
+		}
+		nblock.open.push({next_g_val + next_h_val, next_g_val, next});
+	}
+}
+
+
+int PBNF::acquire(int released)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	if (released >= 0)
+		release(released);
+	if (released >= 0 && num_of_switches % OPEN_SIZE_SAMPLE_INTERVAL == 0)
+	{
+		uint64_t open_size = 0;
+		for (const auto& nblock : nblocks)
+			open_size += nblock.open.size();
+		peak_open_size = max(peak_open_size, open_size);
+	}
+	while (free_list.empty())
+	{
+		if (num_in_use == 0) // every nblock is free of work
+		{
+			condition.notify_all();
+			return -1;
+		}
+		condition.wait(guard);
+	}
+	int best = free_list.begin()->second;
+	free_list.erase(free_list.begin());
+	nblocks[best].in_use = true;
+	num_in_use++;
+	num_of_switches++;
+	for (int other : nblocks[best].interference)
+	{
+		if (nblocks[other].sigma++ == 0 && !nblocks[other].in_use)
+			free_list.erase(make_pair(nblocks[other].best_f_val, other));
+	}
+	best_free_f_val = free_list.empty() ? MAX_COST : free_list.begin()->first;
+	return best;
+}
+
+
+// called with the lock held
+void PBNF::release(int nblock)
+{
+	nblocks[nblock].in_use = false;
+	num_in_use--;
+	for (int other : nblocks[nblock].interference)
+	{
+		if (--nblocks[other].sigma == 0)
+			updateFreeList(other);
+	}
+	updateFreeList(nblock);
+	best_free_f_val = free_list.empty() ? MAX_COST : free_list.begin()->first;
+	condition.notify_all();
+}
+
+
+// Add nblock to the free list if it is free and has open nodes. Its search state is not accessed by any other thread,
+// because every nblock whose scope contains it interferes with it.
+void PBNF::updateFreeList(int nblock)
+{
+	NBlock& curr = nblocks[nblock];
+	if (curr.in_use || curr.sigma > 0)
+		return;
+	curr.best_f_val = getBestFVal(curr);
+	if (curr.best_f_val < MAX_COST)
+		free_list.emplace(curr.best_f_val, nblock);
+}
+
+
+int PBNF::getBestFVal(NBlock& nblock) const
+{
+	while (!nblock.open.empty())
+	{
+		const OpenEntry& top = nblock.open.top();
+		if (top.g_val == top.node->g_val && top.f_val < incumbent.load(std::memory_order_relaxed))
+			return top.f_val;
+		nblock.open.pop();
+	}
+	return MAX_COST;
+}
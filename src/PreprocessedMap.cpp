@@ -0,0 +1,146 @@
+#include "PreprocessedMap.h"
+#include "BidirectionalAStar.h"
+#include "BFHS.h"
+#include "ExternalAStar.h"
+#include "MultiQueueAStar.h"
+#include "GAStarCPU.h"
+#include "PBNF.h"
+
+
+PreprocessedMap::PreprocessedMap(const Instance& instance, const SolverOptions& options):
+	instance(instance), options(options)
+{
+	if (options.heuristic == "RRA*")
+		reverse_searches.reset(new RRAStarCache(instance, options.reverse_searches));
+	else if (options.heuristic == "BFS")
+		heuristic_tables.reset(new HeuristicCache(instance, options.heuristic_memory_mb, options.num_of_threads,
+			options.heuristic_dir));
+}
+
+
+bool PreprocessedMap::isValidAlgorithm(const string& algo)
+{
+	return algo == "A*" || algo == "wA*" || algo == "auto" || algo == "EPEA*" || algo == "BFHS" || algo == "ExternalA*" || algo == "MQA*" ||
+		algo == "GA*" || algo == "PBNF" || algo == "MM" || algo == "SUB" || algo == "BB" || algo == "HPA*";
+}
+
+
+bool PreprocessedMap::prepare(const string& algo)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (algo == "SUB" && subgoal_graph == nullptr)
+	{
+		subgoal_graph.reset(new SubgoalGraph(instance));
+		if (options.screen > 0)
+			cout << "Subgoal graph: " << subgoal_graph->getNumOfSubgoals() << " subgoals, " <<
+				subgoal_graph->num_of_edges << " edges, built in " << subgoal_graph->preprocessing_time << "s" << endl;
+	}
+	else if (algo == "EPEA*" && operator_table == nullptr)
+		operator_table.reset(new OperatorTable(instance));
+	else if (algo == "HPA*" && abstract_graph == nullptr)
+	{
+		if (!options.abstract_graph_file.empty())
+			abstract_graph.reset(new HPAGraph(instance, options.abstract_graph_file));
+		if (abstract_graph == nullptr || abstract_graph->empty() || abstract_graph->cluster_size != options.cluster_size)
+		{
+			abstract_graph.reset(new HPAGraph(instance, options.cluster_size, options.num_of_threads));
+			if (!options.abstract_graph_file.empty() && !abstract_graph->save(options.abstract_graph_file))
+				cerr << "Fail to save the abstract graph to " << options.abstract_graph_file << endl;
+		}
+		if (options.screen > 0)
+			cout << "Abstract graph: " << abstract_graph->getNumOfNodes() << " nodes, " <<
+				abstract_graph->getNumOfEdges() << " edges, built in " << abstract_graph->preprocessing_time << "s" << endl;
+	}
+	else if (algo == "BB" && bounding_boxes == nullptr)
+	{
+		if (!options.bounding_boxes_file.empty())
+			bounding_boxes.reset(new BoundingBoxes(instance, options.bounding_boxes_file));
+		if (bounding_boxes == nullptr || bounding_boxes->empty())
+		{
+			bounding_boxes.reset(new BoundingBoxes(instance, options.num_of_threads));
+			if (bounding_boxes->empty())
+				return false;
+			if (!options.bounding_boxes_file.empty() && !bounding_boxes->save(options.bounding_boxes_file))
+				cerr << "Fail to save the bounding boxes to " << options.bounding_boxes_file << endl;
+		}
+		if (options.screen > 0)
+			cout << "Bounding boxes: built or loaded in " << bounding_boxes->preprocessing_time << "s" << endl;
+	}
+	else if (algo == "auto" && predictor == nullptr)
+	{
+		predictor.reset(new QueryPredictor(instance, 8, options.num_of_threads));
+		if (!options.predictor_model.empty() && !predictor->load(options.predictor_model))
+			cerr << "Fail to load the predictor model " << options.predictor_model << endl;
+		if (options.screen > 0)
+			cout << "Query predictor: built in " << predictor->preprocessing_time << "s" << endl;
+	}
+	return algo != "BB" || !bounding_boxes->empty();
+}
+
+
+string PreprocessedMap::selectAlgorithm(int start, int goal)
+{
+	prepare("auto");
+	if (predictor->predictExpansions(start, goal) <= options.easy_expansions)
+		return "A*";
+	if (options.suboptimality > 1)
+		return "wA*";
+	if (options.num_of_threads > 1)
+		return options.parallel_algo;
+	return "A*";
+}
+
+
+SingleAgentSolver* PreprocessedMap::createSolver(const string& algo, int trial, SearchContext* context, int start,
+	int goal)
+{
+	if (!isValidAlgorithm(algo) || !supportsHeuristic(algo, options.heuristic))
+		return nullptr;
+	if (algo == "auto")
+	{
+		string selected = selectAlgorithm(start >= 0 ? start : instance.getStartLocation(trial),
+			goal >= 0 ? goal : instance.getGoalLocation(trial));
+		// options.parallel_algo = auto would select itself forever
+		return selected == "auto" ? nullptr : createSolver(selected, trial, context, start, goal);
+	}
+	if (!prepare(algo))
+		return nullptr;
+	SingleAgentSolver* planner;
+	if (algo == "A*")
+		planner = new SpaceTimeAStar(instance, trial, context);
+	else if (algo == "wA*")
+	{
+		auto search = new SpaceTimeAStar(instance, trial, context);
+		search->suboptimality = options.suboptimality;
+		planner = search;
+	}
+	else if (algo == "EPEA*")
+		planner = new EPEAStar(instance, trial, *operator_table);
+	else if (algo == "BFHS")
+		planner = new BFHS(instance, trial, options.max_memory_mb);
+	else if (algo == "ExternalA*")
+		planner = new ExternalAStar(instance, trial, options.max_memory_mb, options.external_dir);
+	else if (algo == "MQA*")
+		planner = new MultiQueueAStar(instance, trial, options.num_of_threads);
+	else if (algo == "GA*")
+		planner = new GAStarCPU(instance, trial, options.num_of_threads);
+	else if (algo == "PBNF")
+		planner = new PBNF(instance, trial, options.num_of_threads, options.nblock_size);
+	else if (algo == "MM")
+		planner = new BidirectionalAStar(instance, trial);
+	else if (algo == "SUB")
+		planner = new SubgoalGraphSearch(instance, trial, *subgoal_graph);
+	else if (algo == "BB")
+		planner = new BoundingBoxAStar(instance, trial, *bounding_boxes, context);
+	else
+		planner = new HPAStar(instance, trial, *abstract_graph, options.smooth, context);
+	// the solvers only read their start and goal when they search
+	if (start >= 0)
+		planner->start_location = start;
+	if (goal >= 0)
+		planner->goal_location = goal;
+	if (reverse_searches != nullptr)
+		planner->reverse_search = reverse_searches->get(planner->goal_location);
+	planner->goal_distances = getGoalDistances(planner->goal_location);
+	return planner;
+}
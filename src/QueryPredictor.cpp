@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "QueryPredictor.h"
+#include "MultiSourceBFS.h"
+
+// the obstacle density is measured in the (2 * DENSITY_RADIUS + 1)^2 windows around the start and the goal
+#define DENSITY_RADIUS 8
+
+
+QueryPredictor::QueryPredictor(const Instance& instance, int num_of_landmarks, int num_of_threads): instance(instance)
+{
+	Timer timer;
+	const MapIndex& index = instance.map_index;
+	component_sizes.assign(index.empty() ? 1 : index.num_of_components, 0);
+	for (int loc = 0; loc < instance.map_size; loc++)
+		if (!instance.isObstacle(loc))
+			component_sizes[index.empty() ? 0 : index.getComponent(loc)]++;
+	int largest = (int)(std::max_element(component_sizes.begin(), component_sizes.end()) - component_sizes.begin());
+	int seed = -1;
+	for (int loc = 0; loc < instance.map_size && seed < 0; loc++)
+		if (!instance.isObstacle(loc) && (index.empty() || index.getComponent(loc) == largest))
+			seed = loc;
+	if (seed < 0)
+		return;
+
+	// farthest-point selection, starting from the cell farthest from seed
+	MultiSourceBFS bfs(instance, num_of_threads);
+	vector<int> nearest; // distance to the nearest landmark
+	bfs.computeDistancesToAll({seed}, nearest);
+	int next = seed;
+	for (int loc = 0; loc < instance.map_size; loc++)
+		if (nearest[loc] < MAX_COST && nearest[loc] > nearest[next])
+			next = loc;
+	while ((int)landmark_distances.size() < num_of_landmarks && next >= 0)
+	{
+		landmark_distances.emplace_back();
+		bfs.computeDistancesToAll({next}, landmark_distances.back());
+		const vector<int>& distances = landmark_distances.back();
+		if (landmark_distances.size() == 1)
+			nearest = distances;
+		int farthest = 0;
+		next = -1;
+		for (int loc = 0; loc < instance.map_size; loc++)
+		{
+			if (distances[loc] >= MAX_COST)
+				continue;
+			nearest[loc] = min(nearest[loc], distances[loc]);
+			if (nearest[loc] > farthest)
+			{
+				farthest = nearest[loc];
+				next = loc;
+			}
+		}
+	}
+	preprocessing_time = timer.elapsed();
+}
+
+
+QueryFeatures QueryPredictor::getFeatures(int start, int goal) const
+{
+	QueryFeatures features;
+	features.manhattan_distance = instance.getManhattanDistance(start, goal);
+	int lower_bound = 0;
+	for (const auto& distances : landmark_distances)
+		if (distances[start] < MAX_COST && distances[goal] < MAX_COST)
+			lower_bound = max(lower_bound, abs(distances[start] - distances[goal]));
+	features.landmark_gap = max(0, lower_bound - features.manhattan_distance);
+	int component = instance.map_index.empty() ? 0 : instance.map_index.getComponent(start);
+	features.component_size = component < 0 ? 0 : component_sizes[component]; // 0 for an obstacle
+
+	int num_of_cells = 0, num_of_obstacles = 0; // cells outside the map count as obstacles
+	for (int loc : {start, goal})
+	{
+		int row = instance.getRowCoordinate(loc), col = instance.getColCoordinate(loc);
+		for (int r = row - DENSITY_RADIUS; r <= row + DENSITY_RADIUS; r++)
+		{
+			for (int c = col - DENSITY_RADIUS; c <= col + DENSITY_RADIUS; c++)
+			{
+				num_of_cells++;
+				if (r < 0 || r >= instance.num_of_rows || c < 0 || c >= instance.num_of_cols ||
+					instance.isObstacle(instance.linearizeCoordinate(r, c)))
+					num_of_obstacles++;
+			}
+		}
+	}
+	features.obstacle_density = (double)num_of_obstacles / num_of_cells;
+	return features;
+}
+
+
+void QueryPredictor::getInputs(const QueryFeatures& features, double* inputs) const
+{
+	inputs[0] = 1;
+	inputs[1] = log2(1.0 + features.manhattan_distance);
+	inputs[2] = log2(1.0 + features.landmark_gap);
+	inputs[3] = log2(max(1, features.component_size));
+	inputs[4] = features.obstacle_density;
+}
+
+
+double QueryPredictor::predictExpansions(int start, int goal) const
+{
+	if (!instance.map_index.isReachable(start, goal))
+		return 0; // A* stops at once
+	double inputs[NUM_OF_WEIGHTS];
+	getInputs(getFeatures(start, goal), inputs);
+	double output = 0;
+	for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+		output += weights[i] * inputs[i];
+	return max(0.0, exp2(output) - 1);
+}
+
+
+int QueryPredictor::calibrate(const string& results_file, const string& instance_name, double& rms_error)
+{
+	std::ifstream file(results_file);
+	string line;
+	if (!getline(file, line))
+		return 0;
+	auto split = [](const string& line)
+	{
+		vector<string> fields;
+		std::istringstream stream(line);
+		string field;
+		while (getline(stream, field, ','))
+			fields.push_back(field);
+		return fields;
+	};
+	// the columns of SingleAgentSolver::results_header that are used
+	vector<string> header = split(line);
+	auto column = [&](const string& name)
+	{
+		return (int)(std::find(header.begin(), header.end(), name) - header.begin());
+	};
+	int nproc_column = column("nproc"), expanded_column = column("#node expanded");
+	int name_column = column("instance name"), trial_column = column("trial index");
+	int num_of_columns = (int)header.size();
+	if (max(max(nproc_column, expanded_column), max(name_column, trial_column)) >= num_of_columns)
+		return 0;
+
+	// normal equations of the least squares fit
+	double a[NUM_OF_WEIGHTS][NUM_OF_WEIGHTS + 1] = {};
+	vector< std::pair<vector<double>, double> > samples;
+	while (getline(file, line))
+	{
+		vector<string> fields = split(line);
+		if ((int)fields.size() != num_of_columns || fields[name_column] != instance_name ||
+			atoi(fields[nproc_column].c_str()) != 1)
+			continue;
+		int trial = atoi(fields[trial_column].c_str());
+		if (trial < 0 || trial >= instance.getDefaultNumberOfAgents())
+			continue;
+		int start = instance.getStartLocation(trial), goal = instance.getGoalLocation(trial);
+		if (!instance.map_index.isReachable(start, goal))
+			continue;
+		vector<double> inputs(NUM_OF_WEIGHTS);
+		getInputs(getFeatures(start, goal), inputs.data());
+		double output = log2(1.0 + atof(fields[expanded_column].c_str()));
+		for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+		{
+			for (int j = 0; j < NUM_OF_WEIGHTS; j++)
+				a[i][j] += inputs[i] * inputs[j];
+			a[i][NUM_OF_WEIGHTS] += inputs[i] * output;
+		}
+		samples.emplace_back(inputs, output);
+	}
+	int num_of_samples = (int)samples.size();
+	if (num_of_samples < NUM_OF_WEIGHTS)
+		return 0;
+
+	// Gaussian elimination with partial pivoting; the small ridge term keeps features that do not vary (e.g., the
+	// component size on a connected map) from making the system singular
+	for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+		a[i][i] += 1e-6 * num_of_samples;
+	for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+	{
+		int pivot = i;
+		for (int j = i + 1; j < NUM_OF_WEIGHTS; j++)
+			if (fabs(a[j][i]) > fabs(a[pivot][i]))
+				pivot = j;
+		std::swap(a[i], a[pivot]);
+		for (int j = 0; j < NUM_OF_WEIGHTS; j++)
+		{
+			if (j == i)
+				continue;
+			double factor = a[j][i] / a[i][i];
+			for (int k = i; k <= NUM_OF_WEIGHTS; k++)
+				a[j][k] -= factor * a[i][k];
+		}
+	}
+	for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+		weights[i] = a[i][NUM_OF_WEIGHTS] / a[i][i];
+
+	double squared_error = 0;
+	for (const auto& sample : samples)
+	{
+		double output = 0;
+		for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+			output += weights[i] * sample.first[i];
+		squared_error += (output - sample.second) * (output - sample.second);
+	}
+	rms_error = sqrt(squared_error / num_of_samples);
+	return num_of_samples;
+}
+
+
+bool QueryPredictor::load(const string& model_file)
+{
+	std::ifstream file(model_file);
+	string line;
+	while (getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream stream(line);
+		double loaded[NUM_OF_WEIGHTS];
+		for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+			stream >> loaded[i];
+		if (!stream)
+			return false;
+		std::copy(loaded, loaded + NUM_OF_WEIGHTS, weights);
+		return true;
+	}
+	return false;
+}
+
+
+bool QueryPredictor::save(const string& model_file) const
+{
+	ofstream file(model_file);
+	file << "# log2(1 + A* expansions) = weights . (1, log2(1 + Manhattan distance), log2(1 + landmark gap), " <<
+		"log2(component size), obstacle density)" << endl;
+	file << std::setprecision(10);
+	for (int i = 0; i < NUM_OF_WEIGHTS; i++)
+		file << weights[i] << (i + 1 < NUM_OF_WEIGHTS ? " " : "\n");
+	return file.good();
+}
@@ -0,0 +1,233 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "QueryServer.h"
+#include "ResultWriter.h"
+
+// larger requests are malformed, and their connections are closed
+#define MAX_REQUEST_SIZE 1024
+
+
+// read exactly size bytes, unless the input ends
+static bool readFully(int fd, char* data, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t n = ::read(fd, data, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+
+template<typename T>
+static void appendValue(string& buffer, T value)
+{
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+QueryServer::QueryServer(const vector<PreprocessedMap*>& maps, const string& default_algo, int num_of_workers):
+	maps(maps), default_algo(default_algo), num_of_workers(max(num_of_workers, 1)) {}
+
+
+QueryServer::Connection::~Connection()
+{
+	if (!owned)
+		return;
+	close(input);
+	if (output != input)
+		close(output);
+}
+
+
+void QueryServer::Connection::send(const string& payload)
+{
+	string frame;
+	appendValue(frame, (uint32_t)payload.size());
+	frame += payload;
+	std::lock_guard<std::mutex> guard(lock);
+	const char* data = frame.data();
+	size_t size = frame.size();
+	while (size > 0)
+	{
+		ssize_t n = write(output, data, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return; // the client is gone
+		data += n;
+		size -= n;
+	}
+}
+
+
+bool QueryServer::run(const string& address)
+{
+	signal(SIGPIPE, SIG_IGN); // a client that disconnects early must not stop the server
+	vector<std::thread> workers;
+	for (int i = 0; i < num_of_workers; i++)
+		workers.emplace_back(&QueryServer::work, this);
+	bool succ = true;
+	if (address == "stdin")
+		read(std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false));
+	else
+	{
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		int server = socket(AF_UNIX, SOCK_STREAM, 0);
+		succ = server >= 0 && address.size() < sizeof(addr.sun_path);
+		if (succ)
+		{
+			strcpy(addr.sun_path, address.c_str());
+			unlink(address.c_str());
+			succ = bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 && listen(server, SOMAXCONN) == 0;
+		}
+		if (!succ)
+			cerr << "Fail to listen on " << address << ": " << strerror(errno) << endl;
+		while (succ)
+		{
+			int client = accept(server, nullptr, nullptr);
+			if (client >= 0)
+				std::thread(&QueryServer::read, this, std::make_shared<Connection>(client, client, true)).detach();
+			else if (errno != EINTR && errno != ECONNABORTED)
+			{
+				cerr << "Fail to accept connections on " << address << ": " << strerror(errno) << endl;
+				succ = false;
+			}
+		}
+		if (server >= 0)
+			close(server);
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		closed = true;
+	}
+	ready.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+	return succ;
+}
+
+
+void QueryServer::read(const shared_ptr<Connection>& connection)
+{
+	uint32_t size;
+	vector<char> payload;
+	while (readFully(connection->input, reinterpret_cast<char*>(&size), sizeof(size)) && size <= MAX_REQUEST_SIZE)
+	{
+		payload.resize(size);
+		if (!readFully(connection->input, payload.data(), size))
+			break;
+		Query query;
+		query.connection = connection;
+		uint8_t name_length = size >= 7 ? payload[6] : 0;
+		if (size != 7u + name_length + 16)
+		{
+			string response;
+			appendValue(response, size >= 4 ? *reinterpret_cast<const uint32_t*>(payload.data()) : 0u);
+			appendValue(response, (int32_t)QUERY_INVALID);
+			response += "malformed request";
+			connection->send(response);
+			continue;
+		}
+		const char* data = payload.data();
+		uint16_t map;
+		int32_t coordinates[4];
+		memcpy(&query.id, data, sizeof(query.id));
+		memcpy(&map, data + 4, sizeof(map));
+		query.map = map;
+		query.algo.assign(data + 7, name_length);
+		memcpy(coordinates, data + 7 + name_length, sizeof(coordinates));
+		query.start_row = coordinates[0];
+		query.start_col = coordinates[1];
+		query.goal_row = coordinates[2];
+		query.goal_col = coordinates[3];
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			queries.push_back(std::move(query));
+		}
+		ready.notify_one();
+	}
+}
+
+
+void QueryServer::work()
+{
+	vector< std::unique_ptr<SearchContext> > contexts(maps.size()); // of this worker, one per map
+	while (true)
+	{
+		Query query;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			ready.wait(guard, [&]() { return closed || !queries.empty(); });
+			if (queries.empty())
+				return;
+			query = std::move(queries.front());
+			queries.pop_front();
+		}
+		query.connection->send(answer(query, contexts));
+	}
+}
+
+
+string QueryServer::answer(const Query& query, vector< std::unique_ptr<SearchContext> >& contexts)
+{
+	string response;
+	appendValue(response, query.id);
+	auto invalid = [&](const string& message)
+	{
+		appendValue(response, (int32_t)QUERY_INVALID);
+		response += message;
+		return response;
+	};
+	if (query.map >= (int)maps.size())
+		return invalid("unknown map " + std::to_string(query.map));
+	PreprocessedMap& map = *maps[query.map];
+	const Instance& instance = map.instance;
+	string algo = query.algo.empty() ? default_algo : query.algo;
+	if (!PreprocessedMap::isValidAlgorithm(algo))
+		return invalid("unknown algorithm " + algo);
+	if (!PreprocessedMap::supportsHeuristic(algo, map.options.heuristic))
+		return invalid(algo + " does not support the " + map.options.heuristic + " heuristic");
+	auto isFree = [&](int row, int col)
+	{
+		return row >= 0 && row < instance.num_of_rows && col >= 0 && col < instance.num_of_cols &&
+			!instance.isObstacle(instance.linearizeCoordinate(row, col));
+	};
+	if (!isFree(query.start_row, query.start_col) || !isFree(query.goal_row, query.goal_col))
+		return invalid("the start or the goal is not a free cell of map " + std::to_string(query.map));
+
+	SearchContext* context = nullptr;
+	if (PreprocessedMap::usesSearchContext(algo))
+	{
+		if (contexts[query.map] == nullptr)
+			contexts[query.map].reset(new SearchContext(instance));
+		context = contexts[query.map].get();
+	}
+	Timer timer;
+	// the query is not a trial of the agent file, so it only gives the start and the goal
+	std::unique_ptr<SingleAgentSolver> planner(map.createSolver(algo, -1, context,
+		instance.linearizeCoordinate(query.start_row, query.start_col),
+		instance.linearizeCoordinate(query.goal_row, query.goal_col)));
+	if (planner == nullptr)
+		return invalid("no solver of " + algo + " for these options");
+	Path path = planner->findOptimalPath();
+	double runtime = timer.elapsed();
+	appendValue(response, (int32_t)(path.empty() ? QUERY_UNSOLVED : QUERY_SOLVED));
+	appendValue(response, (int32_t)path.size() - 1);
+	appendValue(response, planner->num_expanded);
+	appendValue(response, planner->num_generated);
+	appendValue(response, runtime);
+	appendBinaryPath(instance, path, response);
+	return response;
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include "RRAStar.h"
+
+
+RRAStar::RRAStar(const Instance& instance, int goal):
+	instance(instance), goal_location(goal), g_vals(instance.map_size, MAX_COST), closed(instance.map_size, false)
+{
+	g_vals[goal] = 0;
+	open_list.emplace_back(0, 0, goal);
+}
+
+
+int RRAStar::getDistance(int loc, int start)
+{
+	if (!closed[loc])
+	{
+		setStart(start);
+		resume(loc);
+	}
+	return closed[loc] ? g_vals[loc] : MAX_COST;
+}
+
+
+void RRAStar::setStart(int start)
+{
+	if (start == start_location)
+		return;
+	start_location = start;
+	// drop stale entries and recompute the f-values of the remaining ones with the new heuristic
+	size_t size = 0;
+	for (const auto& entry : open_list)
+	{
+		int loc = get<2>(entry);
+		if (closed[loc] || g_vals[loc] != -get<1>(entry))
+			continue;
+		open_list[size++] = make_tuple(g_vals[loc] + instance.getManhattanDistance(loc, start), -g_vals[loc], loc);
+	}
+	open_list.resize(size);
+	std::make_heap(open_list.begin(), open_list.end(), std::greater<entry_t>());
+}
+
+
+void RRAStar::resume(int loc)
+{
+	while (!open_list.empty() && !closed[loc])
+	{
+		std::pop_heap(open_list.begin(), open_list.end(), std::greater<entry_t>());
+		int curr = get<2>(open_list.back());
+		int g_val = -get<1>(open_list.back());
+		open_list.pop_back();
+		if (closed[curr] || g_vals[curr] != g_val) // stale entry
+			continue;
+		closed[curr] = true;
+		num_expanded++;
+		for (int next : instance.getNeighbors(curr))
+		{
+			if (g_vals[next] <= g_val + 1)
+				continue;
+			g_vals[next] = g_val + 1;
+			open_list.emplace_back(g_val + 1 + instance.getManhattanDistance(next, start_location), -g_val - 1, next);
+			std::push_heap(open_list.begin(), open_list.end(), std::greater<entry_t>());
+		}
+	}
+}
+
+
+RRAStar* RRAStarCache::get(int goal)
+{
+	auto it = searches.find(goal);
+	if (it != searches.end())
+		return it->second.get();
+	if (capacity > 0 && (int)goals.size() >= capacity)
+	{
+		searches.erase(goals.front());
+		goals.pop_front();
+	}
+	goals.push_back(goal);
+	RRAStar* search = new RRAStar(instance, goal);
+	searches[goal].reset(search);
+	return search;
+}
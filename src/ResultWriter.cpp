@@ -0,0 +1,255 @@
+#include <cstring>
+#include "ResultWriter.h"
+
+// buffered bytes at which the background thread is woken up
+#define WRITE_SIZE (1 << 20)
+
+
+ResultWriter::ResultWriter(const Instance& instance, const string& resultsFile, const string& instanceName,
+	const string& pathsFile, bool binaryPaths):
+	instance(instance), instance_name(instanceName), binary_paths(binaryPaths)
+{
+	if (!resultsFile.empty())
+	{
+		// the lines are only appended to a file with the same columns (the caller checks hasCurrentColumns first)
+		string header;
+		bool empty = !getline(std::ifstream(resultsFile), header);
+		if (!hasCurrentColumns(resultsFile))
+			cerr << "The columns of " << resultsFile << " differ from the current ones, so the results are not saved" <<
+				endl;
+		else
+		{
+			results_file.open(resultsFile, std::ios::app);
+			if (!results_file.is_open())
+				cerr << "Fail to open " << resultsFile << endl;
+			else if (empty)
+				results_buffer += string(SingleAgentSolver::results_header) + "\n";
+		}
+	}
+	if (!pathsFile.empty())
+	{
+		// text paths are appended to the file; a binary file has one header, so it is replaced
+		paths_file.open(pathsFile, binary_paths ? std::ios::binary | std::ios::trunc : std::ios::app);
+		if (!paths_file.is_open())
+			cerr << "Fail to open " << pathsFile << endl;
+		else if (binary_paths)
+		{
+			int32_t dims[2] = {instance.num_of_rows, instance.num_of_cols};
+			paths_buffer.append(PATH_FILE_MAGIC, 8);
+			paths_buffer.append(reinterpret_cast<const char*>(dims), sizeof(dims));
+		}
+	}
+	writer = std::thread(&ResultWriter::write, this);
+}
+
+
+bool ResultWriter::hasCurrentColumns(const string& resultsFile)
+{
+	std::ifstream existing(resultsFile);
+	string header;
+	return !getline(existing, header) || header == SingleAgentSolver::results_header;
+}
+
+
+ResultWriter::~ResultWriter()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		done = true;
+	}
+	ready.notify_one();
+	writer.join();
+	if (results_file.is_open() && !results_file.good())
+		cerr << "Fail to write the results" << endl;
+	if (paths_file.is_open() && !paths_file.good())
+		cerr << "Fail to write the paths" << endl;
+}
+
+
+void ResultWriter::addResults(const SingleAgentSolver& solver)
+{
+	if (results_file.is_open())
+		addResults(solver.getResults(instance_name));
+}
+
+
+void ResultWriter::addResults(const string& line)
+{
+	if (!results_file.is_open())
+		return;
+	string record = line + "\n";
+	append(results_buffer, record.data(), record.size());
+}
+
+
+void ResultWriter::addPath(const SingleAgentSolver& solver)
+{
+	if (!paths_file.is_open())
+		return;
+	const Path& path = solver.planned_path;
+	string record;
+	if (!binary_paths)
+	{
+		record = "Trial " + std::to_string(solver.trial_idx) + ": ";
+		char step[32];
+		for (const auto& entry : path)
+			record.append(step, snprintf(step, sizeof(step), "(%d,%d)->", instance.getRowCoordinate(entry.location),
+				instance.getColCoordinate(entry.location)));
+		record += "\n";
+		append(paths_buffer, record.data(), record.size());
+		return;
+	}
+
+	int32_t trial = solver.trial_idx;
+	record.append(reinterpret_cast<const char*>(&trial), sizeof(trial));
+	appendBinaryPath(instance, path, record);
+	append(paths_buffer, record.data(), record.size());
+}
+
+
+void ResultWriter::append(string& buffer, const char* data, size_t size)
+{
+	bool full;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		buffer.append(data, size);
+		full = results_buffer.size() + paths_buffer.size() >= WRITE_SIZE;
+	}
+	if (full)
+		ready.notify_one();
+}
+
+
+void ResultWriter::write()
+{
+	string results, paths; // swapped with the buffers, so that the trials keep appending while they are written
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		ready.wait(guard, [&]() { return done || results_buffer.size() + paths_buffer.size() >= WRITE_SIZE; });
+		bool last = done;
+		results.swap(results_buffer);
+		paths.swap(paths_buffer);
+		guard.unlock();
+		results_file.write(results.data(), results.size());
+		paths_file.write(paths.data(), paths.size());
+		results.clear();
+		paths.clear();
+		if (last)
+			break;
+		guard.lock();
+	}
+	results_file.flush();
+	paths_file.flush();
+}
+
+
+void appendBinaryPath(const Instance& instance, const Path& path, string& buffer)
+{
+	int32_t length = (int32_t)path.size();
+	vector<uint8_t> moves((path.size() + 2) / 4, 0);
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		int row_diff = instance.getRowCoordinate(path[i].location) - instance.getRowCoordinate(path[i - 1].location);
+		int col_diff = instance.getColCoordinate(path[i].location) - instance.getColCoordinate(path[i - 1].location);
+		int direction;
+		if (row_diff == 0 && col_diff == 1)
+			direction = Instance::RIGHT;
+		else if (row_diff == 0 && col_diff == -1)
+			direction = Instance::LEFT;
+		else if (row_diff == 1 && col_diff == 0)
+			direction = Instance::DOWN;
+		else if (row_diff == -1 && col_diff == 0)
+			direction = Instance::UP;
+		else
+		{
+			length = -length; // not a move, so the locations are stored as they are
+			break;
+		}
+		moves[(i - 1) / 4] |= direction << (2 * ((i - 1) % 4));
+	}
+	buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+	if (length > 0)
+	{
+		int32_t start[2] = {instance.getRowCoordinate(path.front().location),
+			instance.getColCoordinate(path.front().location)};
+		buffer.append(reinterpret_cast<const char*>(start), sizeof(start));
+		buffer.append(reinterpret_cast<const char*>(moves.data()), moves.size());
+	}
+	else
+	{
+		for (const auto& entry : path)
+		{
+			int32_t loc = instance.getRowCoordinate(entry.location) * instance.num_of_cols +
+				instance.getColCoordinate(entry.location);
+			buffer.append(reinterpret_cast<const char*>(&loc), sizeof(loc));
+		}
+	}
+}
+
+
+bool convertPaths(const string& binaryFile, const string& textFile)
+{
+	std::ifstream input(binaryFile, std::ios::binary);
+	char magic[8];
+	int32_t dims[2];
+	if (!input.read(magic, 8) || memcmp(magic, PATH_FILE_MAGIC, 8) != 0 ||
+		!input.read(reinterpret_cast<char*>(dims), sizeof(dims)))
+	{
+		cerr << binaryFile << " is not a binary path file" << endl;
+		return false;
+	}
+	ofstream output(textFile, std::ios::app);
+	if (!output.is_open())
+		return false;
+	int num_of_cols = dims[1];
+	const int rows[4] = {0, 0, 1, -1}, cols[4] = {1, -1, 0, 0}; // of the moves in Instance::direction_t
+	int32_t fields[2];
+	vector<uint8_t> moves;
+	vector<int32_t> locations;
+	string line;
+	char step[32];
+	bool truncated = false;
+	while (input.read(reinterpret_cast<char*>(fields), sizeof(fields)))
+	{
+		line = "Trial " + std::to_string(fields[0]) + ": ";
+		if (fields[1] > 0)
+		{
+			int32_t start[2];
+			moves.resize((fields[1] + 2) / 4);
+			if (!input.read(reinterpret_cast<char*>(start), sizeof(start)) ||
+				!input.read(reinterpret_cast<char*>(moves.data()), moves.size()))
+			{
+				truncated = true;
+				break;
+			}
+			int row = start[0], col = start[1];
+			line.append(step, snprintf(step, sizeof(step), "(%d,%d)->", row, col));
+			for (int i = 0; i < fields[1] - 1; i++)
+			{
+				int direction = moves[i / 4] >> (2 * (i % 4)) & 3;
+				row += rows[direction];
+				col += cols[direction];
+				line.append(step, snprintf(step, sizeof(step), "(%d,%d)->", row, col));
+			}
+		}
+		else if (fields[1] < 0)
+		{
+			locations.resize(-fields[1]);
+			if (!input.read(reinterpret_cast<char*>(locations.data()), locations.size() * sizeof(int32_t)))
+			{
+				truncated = true;
+				break;
+			}
+			for (int32_t loc : locations)
+				line.append(step, snprintf(step, sizeof(step), "(%d,%d)->", loc / num_of_cols, loc % num_of_cols));
+		}
+		output << line << "\n";
+	}
+	if (truncated || input.gcount() > 0)
+	{
+		cerr << binaryFile << " is truncated" << endl;
+		return false;
+	}
+	return output.good();
+}
@@ -0,0 +1,120 @@
+#include "SearchContext.h"
+
+const int SearchContext::CLOSED;
+
+
+SearchContext::SearchContext(const Instance& instance)
+{
+#ifdef SEARCH_CONTEXT_SOA
+	g_vals.resize(instance.map_size);
+	parents.resize(instance.map_size);
+	generations.resize(instance.map_size, 0);
+	heap_indices.resize(instance.map_size, CLOSED);
+#else
+	nodes.resize(instance.map_size, {0, -1, 0, CLOSED});
+#endif
+}
+
+
+void SearchContext::reset()
+{
+	open.clear();
+	path.clear();
+	num_of_generated = 0;
+	num_of_resets++;
+	if (++generation == 0) // wrapped around after 2^32 resets
+	{
+#ifdef SEARCH_CONTEXT_SOA
+		std::fill(generations.begin(), generations.end(), 0);
+#else
+		for (auto& node : nodes)
+			node.generation = 0;
+#endif
+		generation = 1;
+	}
+}
+
+
+void SearchContext::generate(int location, int g_val, int h_val, int parent)
+{
+	generationOf(location) = generation;
+	gValOf(location) = g_val;
+	parentOf(location) = parent;
+	num_of_generated++;
+	push({g_val + h_val, h_val, location});
+}
+
+
+void SearchContext::improve(int location, int g_val, int parent)
+{
+	size_t index = heapIndexOf(location);
+	open[index].f_val = g_val + open[index].h_val;
+	gValOf(location) = g_val;
+	parentOf(location) = parent;
+	siftUp(index);
+}
+
+
+void SearchContext::reopen(int location, int g_val, int h_val, int parent)
+{
+	gValOf(location) = g_val;
+	parentOf(location) = parent;
+	push({g_val + h_val, h_val, location});
+}
+
+
+void SearchContext::push(const OpenEntry& entry)
+{
+	open.push_back(entry);
+	siftUp(open.size() - 1);
+}
+
+
+SearchContext::OpenEntry SearchContext::pop()
+{
+	OpenEntry top = open.front();
+	heapIndexOf(top.location) = CLOSED;
+	open.front() = open.back();
+	open.pop_back();
+	if (!open.empty())
+		siftDown(0);
+	return top;
+}
+
+
+void SearchContext::siftUp(size_t index)
+{
+	OpenEntry entry = open[index];
+	while (index > 0)
+	{
+		size_t parent = (index - 1) / 2;
+		if (!better(entry, open[parent]))
+			break;
+		open[index] = open[parent];
+		heapIndexOf(open[index].location) = (int)index;
+		index = parent;
+	}
+	open[index] = entry;
+	heapIndexOf(entry.location) = (int)index;
+}
+
+
+void SearchContext::siftDown(size_t index)
+{
+	OpenEntry entry = open[index];
+	while (true)
+	{
+		size_t child = 2 * index + 1;
+		if (child >= open.size())
+			break;
+		if (child + 1 < open.size() && better(open[child + 1], open[child]))
+			child++;
+		if (!better(open[child], entry))
+			break;
+		open[index] = open[child];
+		heapIndexOf(open[index].location) = (int)index;
+		index = child;
+	}
+	open[index] = entry;
+	heapIndexOf(entry.location) = (int)index;
+}
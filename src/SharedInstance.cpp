@@ -0,0 +1,107 @@
+#include <cstring>
+#include "SharedInstance.h"
+#include "MultiSourceBFS.h"
+
+
+// size bytes in the memory of the first rank of node_comm, written by it before publish(window)
+static char* allocate(MPI_Comm node_comm, size_t size, MPI_Win& window)
+{
+	int node_rank;
+	MPI_Comm_rank(node_comm, &node_rank);
+	char* base;
+	MPI_Win_allocate_shared(node_rank == 0 ? (MPI_Aint)size : 0, 1, MPI_INFO_NULL, node_comm, &base, &window);
+	MPI_Aint segment_size;
+	int disp_unit;
+	MPI_Win_shared_query(window, 0, &segment_size, &disp_unit, &base);
+	// a passive-target epoch for the lifetime of the window, in which the memory is accessed by loads and stores
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+	return base;
+}
+
+
+static void publish(MPI_Comm node_comm, MPI_Win window)
+{
+	MPI_Win_sync(window);
+	MPI_Barrier(node_comm);
+	MPI_Win_sync(window);
+}
+
+
+static void release(MPI_Win& window)
+{
+	if (window == MPI_WIN_NULL)
+		return;
+	MPI_Win_unlock_all(window);
+	MPI_Win_free(&window);
+}
+
+
+SharedGoalDistances::SharedGoalDistances(const Instance& instance, MPI_Comm comm): instance(instance)
+{
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+	MPI_Comm_rank(node_comm, &node_rank);
+}
+
+
+SharedGoalDistances::~SharedGoalDistances()
+{
+	release(window);
+	MPI_Comm_free(&node_comm);
+}
+
+
+shared_ptr<const int> SharedGoalDistances::get(int goal)
+{
+	if (goal != this->goal)
+	{
+		release(window);
+		int* distances = reinterpret_cast<int*>(allocate(node_comm, (size_t)instance.map_size * sizeof(int), window));
+		if (node_rank == 0)
+		{
+			vector<int> computed;
+			MultiSourceBFS(instance).computeDistancesToAll({goal}, computed);
+			memcpy(distances, computed.data(), computed.size() * sizeof(int));
+		}
+		publish(node_comm, window);
+		table = distances;
+		this->goal = goal;
+	}
+	return shared_ptr<const int>(table, [](const int*) {});
+}
+
+
+SharedInstance::SharedInstance(MPI_Comm comm, const string& map_fname, const string& agent_fname, int num_of_agents,
+	int tile_size)
+{
+	Timer timer;
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+	MPI_Comm_rank(node_comm, &node_rank);
+	MPI_Comm_size(node_comm, &num_of_node_ranks);
+	std::unique_ptr<Instance> loaded;
+	uint64_t size = 0;
+	if (node_rank == 0)
+	{
+		loaded.reset(new Instance(map_fname, agent_fname, num_of_agents, 0, 0, 0, 0, tile_size));
+		size = loaded->getSharedSize();
+	}
+	MPI_Bcast(&size, 1, MPI_UINT64_T, 0, node_comm);
+	shared_size = size;
+	char* shared = allocate(node_comm, shared_size, instance_window);
+	if (node_rank == 0)
+		loaded->copyToShared(shared);
+	loaded.reset();
+	publish(node_comm, instance_window);
+	// the window is freed by the destructor, after the instance
+	instance.reset(new Instance(shared, shared_ptr<const void>(shared, [](const void*) {})));
+	goal_distances.reset(new SharedGoalDistances(*instance, comm));
+	loading_time = timer.elapsed();
+}
+
+
+SharedInstance::~SharedInstance()
+{
+	goal_distances.reset();
+	instance.reset();
+	release(instance_window);
+	MPI_Comm_free(&node_comm);
+}
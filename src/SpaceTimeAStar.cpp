@@ -1,18 +1,13 @@
 #include "SpaceTimeAStar.h"
+#include "BoundingBoxes.h"
 
 
-void SpaceTimeAStar::updatePath(const LLNode* goal, vector<PathEntry> &path)
+void SpaceTimeAStar::updatePath(int goal)
 {
-    const LLNode* curr = goal;
-    if (curr->is_goal)
-        curr = curr->parent;
-    path.reserve(curr->g_val + 1);
-    while (curr != nullptr)
-    {
-        path.emplace_back(curr->location);
-        curr = curr->parent;
-    }
-    std::reverse(path.begin(),path.end());
+    Path& path = context->path;
+    path.resize(context->getGVal(goal) + 1);
+    for (int curr = goal; curr >= 0; curr = context->getParent(curr))
+        path[context->getGVal(curr)] = curr;
 }
 
 
@@ -27,109 +22,134 @@ Path SpaceTimeAStar::findOptimalPath()
 // lowerbound is an underestimation of the length of the path in order to speed up the search.
 Path SpaceTimeAStar::findSuboptimalPath()
 {
-    Path path;
+    started = false;
+    cancelled = false;
+    while (step(UINT64_MAX) == SearchStatus::IN_PROGRESS) {}
+    planned_path = context->path;
+    return planned_path;
+}
+
+
+void SpaceTimeAStar::start()
+{
     num_expanded = 0;
     num_generated = 0;
+    num_allocated = 0;
+    peak_open_size = 0;
+    status = SearchStatus::IN_PROGRESS;
+    started = true;
+    if (context == nullptr)
+    {
+        own_context.reset(new SearchContext(instance));
+        context = own_context.get();
+    }
+    context->reset();
+    corridor = instance.map_index.getCorridor(start_location, goal_location);
+    if (!corridor.isReachable())
+    {
+        finish(SearchStatus::FAILED);
+        return;
+    }
 
-    // generate start and add it to the OPEN & FOCAL list
-    auto start = new AStarNode(start_location, 0, compute_heuristic(start_location, goal_location), nullptr, 0, 0);
+    // generate start and add it to the OPEN list
+    min_f_val = weigh(compute_heuristic(start_location, goal_location));
+    context->generate(start_location, 0, min_f_val, -1);
+    num_generated++;
+    peak_open_size = 1;
+}
+
+
+int SpaceTimeAStar::getMinFVal() const
+{
+    if (context == nullptr || context->openEmpty())
+        return min_f_val;
+    return context->openTop().f_val;
+}
 
-    pushNode(start);
-    allNodes_table.insert(start);
-    min_f_val = (int) start->getFVal();
-    // lower_bound = int(w * min_f_val));
 
-    while (!open_list.empty())
+SearchStatus SpaceTimeAStar::step(uint64_t max_expansions, double max_seconds)
+{
+    if (!started)
+        start();
+    if (status != SearchStatus::IN_PROGRESS)
+        return status;
+    Timer timer;
+    for (uint64_t i = 0; i < max_expansions; i++)
     {
-        auto* curr = popNode();
-        assert(curr->location >= 0);
-        // check if the popped node is a goal
-        if (curr->location == goal_location) // arrive at the goal location
+        if (cancelled)
+        {
+            finish(SearchStatus::CANCELLED);
+            return status;
+        }
+        if (context->openEmpty())
         {
-            updatePath(curr, path);
+            finish(SearchStatus::FAILED);
+            return status;
+        }
+        // the clock is checked every 16 expansions
+        if (max_seconds > 0 && i > 0 && i % 16 == 0 && timer.elapsed() >= max_seconds)
             break;
+
+        auto top = context->pop();
+        int curr = top.location;
+        int curr_g_val = context->getGVal(curr);
+        num_expanded++;
+        min_f_val = top.f_val;
+        // check if the popped node is a goal
+        if (curr == goal_location) // arrive at the goal location
+        {
+            updatePath(curr);
+            finish(SearchStatus::FOUND);
+            return status;
         }
 
-        auto next_locations = instance.getNeighbors(curr->location);
-        next_locations.emplace_back(curr->location);
-        for (int next_location : next_locations)
+        // the Manhattan distances come with the successors; other heuristics are computed when needed
+        bool manhattan = reverse_search == nullptr && goal_distances == nullptr;
+        int next_locations[4], manhattan_h_vals[4];
+        int num_of_neighbors = bounding_boxes == nullptr ?
+            instance.getSuccessors(curr, goal_location, next_locations, manhattan_h_vals) :
+            bounding_boxes->getSuccessors(curr, goal_location, next_locations, manhattan_h_vals);
+        for (int j = 0; j < num_of_neighbors; j++)
         {
-            int next_timestep = curr->timestep + 1;
+            int next_location = next_locations[j];
             // compute cost to next_id via curr node
-            int next_g_val = curr->g_val + 1;
-            int next_h_val = compute_heuristic(next_location, goal_location);
-            
-            // generate (maybe temporary) node
-            auto next = new AStarNode(next_location, next_g_val, next_h_val,
-                                      curr, next_timestep);
-            
-            // try to retrieve it from the hash table
-            auto it = allNodes_table.find(next);
-            if (it == allNodes_table.end())
+            int next_g_val = curr_g_val + 1;
+            if (!context->isGenerated(next_location))
             {
-                // not in hash table
-                pushNode(next);
-                allNodes_table.insert(next);
-                continue;
+                if (!instance.map_index.inCorridor(corridor, next_location))
+                    continue;
+                int next_h_val = manhattan ? manhattan_h_vals[j] :
+                    compute_heuristic(next_location, goal_location);
+                if (next_h_val >= MAX_COST) // the goal is unreachable from next_location
+                    continue;
+                context->generate(next_location, next_g_val, weigh(next_h_val), curr);
             }
-
-            // update existing node's if needed (only in the open_list)
-            auto existing_next = *it;
-            if (existing_next->getFVal() > next->getFVal()) // if f-val decreased through this new path
+            else
             {
-                if (!existing_next->in_openlist) // if it is in the closed list (reopen)
-                {
-                    existing_next->copy(*next);
-                    pushNode(existing_next);
-                }
-                else
-                {
-                    bool update_open = false;
-                    if (existing_next->getFVal() > next->getFVal())
-                        update_open = true;
-
-                    existing_next->copy(*next);	// update existing node
-
-                    if (update_open)
-                        open_list.increase(existing_next->open_handle);  // increase because f-val improved
-                }
+                // update the existing node if the f-val decreased through this new path
+                if (context->getGVal(next_location) <= next_g_val)
+                    continue;
+                if (context->isOpen(next_location))
+                    context->improve(next_location, next_g_val, curr);
+                else if (suboptimality > 1) // weighted A* keeps its bound without reopening closed nodes
+                    continue;
+                else // reopen, with the h-val recomputed
+                    context->reopen(next_location, next_g_val, weigh(manhattan ? manhattan_h_vals[j] :
+                        compute_heuristic(next_location, goal_location)), curr);
             }
-
-            delete(next);  // not needed anymore -- we already generated it before
+            num_generated++;
+            peak_open_size = max(peak_open_size, (uint64_t)context->openSize());
         }  // end for loop that generates successors
-    }  // end while loop
-
-    releaseNodes();
-    planned_path = path;
-    path_cost = path.size() - 1;
-    return path;
-}
-
-
-inline AStarNode* SpaceTimeAStar::popNode()
-{
-    auto node = open_list.top(); open_list.pop();
-    // open_list.erase(node->open_handle);
-    node->in_openlist = false;
-    num_expanded++;
-    return node;
-}
-
-
-inline void SpaceTimeAStar::pushNode(AStarNode* node)
-{
-    node->open_handle = open_list.push(node);
-    node->in_openlist = true;
-    num_generated++;
+    }
+    return status;
 }
 
 
-
-
-void SpaceTimeAStar::releaseNodes()
+void SpaceTimeAStar::finish(SearchStatus result)
 {
-    open_list.clear();
-    for (auto node: allNodes_table)
-        delete node;
-    allNodes_table.clear();
+    status = result;
+    if (result != SearchStatus::FOUND)
+        context->path.clear();
+    num_allocated = context->getNumOfGenerated();
+    path_cost = context->path.size() - 1;
 }
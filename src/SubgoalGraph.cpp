@@ -0,0 +1,256 @@
+#include "SubgoalGraph.h"
+
+
+SubgoalGraph::SubgoalGraph(const Instance& instance): instance(instance)
+{
+	Timer timer;
+	subgoal_id.resize(instance.map_size, -1);
+	for (int loc = 0; loc < instance.map_size; loc++)
+	{
+		if (isCorner(loc))
+		{
+			subgoal_id[loc] = (int)subgoals.size();
+			subgoals.push_back(loc);
+		}
+	}
+
+	edges.resize(subgoals.size());
+	vector< pair<int, int> > reachable;
+	for (int i = 0; i < (int)subgoals.size(); i++)
+	{
+		reachable.clear();
+		getDirectHReachable(subgoals[i], reachable);
+		for (const auto& entry : reachable)
+			edges[i].emplace_back(subgoal_id[entry.first], entry.second);
+		num_of_edges += (int)reachable.size();
+	}
+	preprocessing_time = timer.elapsed();
+}
+
+
+// a free cell is a subgoal if one of its diagonal neighbors is blocked
+// while the two cells between them are both free
+bool SubgoalGraph::isCorner(int loc) const
+{
+	if (instance.isObstacle(loc))
+		return false;
+	int row = instance.getRowCoordinate(loc);
+	int col = instance.getColCoordinate(loc);
+	for (int dr = -1; dr <= 1; dr += 2)
+	{
+		for (int dc = -1; dc <= 1; dc += 2)
+		{
+			int r = row + dr, c = col + dc;
+			if (r < 0 || r >= instance.num_of_rows || c < 0 || c >= instance.num_of_cols)
+				continue;
+			if (!isFree(r, c) && isFree(row + dr, col) && isFree(row, col + dc))
+				return true;
+		}
+	}
+	return false;
+}
+
+
+// sweep each of the four quadrants around loc row by row: a cell is reached if it is free and its
+// predecessor towards loc (in the row or in the column) is reached and is not a subgoal
+void SubgoalGraph::getDirectHReachable(int loc, vector< pair<int, int> >& reachable, int target) const
+{
+	enum reach_t { UNREACHED, OPEN, STOP };
+	int row = instance.getRowCoordinate(loc);
+	int col = instance.getColCoordinate(loc);
+	size_t offset = reachable.size();
+	vector<char> prev(instance.num_of_cols + 1), curr(instance.num_of_cols + 1);
+	for (int dr = -1; dr <= 1; dr += 2)
+	{
+		for (int dc = -1; dc <= 1; dc += 2)
+		{
+			int prev_len = 0;
+			for (int i = 0; ; i++)
+			{
+				int r = row + i * dr;
+				if (r < 0 || r >= instance.num_of_rows)
+					break;
+				bool any = false;
+				int j = 0;
+				for (; ; j++)
+				{
+					int c = col + j * dc;
+					if (c < 0 || c >= instance.num_of_cols)
+						break;
+					bool reached;
+					if (i == 0 && j == 0)
+						reached = true;
+					else
+						reached = isFree(r, c) && ((j > 0 && curr[j - 1] == OPEN) || (j < prev_len && prev[j] == OPEN));
+					if (!reached)
+					{
+						if (j >= prev_len)
+							break;
+						curr[j] = UNREACHED;
+						continue;
+					}
+					any = true;
+					int next = instance.linearizeCoordinate(r, c);
+					if (next != loc && (subgoal_id[next] >= 0 || next == target))
+					{
+						reachable.emplace_back(next, i + j);
+						curr[j] = STOP;
+					}
+					else
+					{
+						curr[j] = OPEN;
+					}
+				}
+				prev_len = j;
+				std::swap(prev, curr);
+				if (!any)
+					break;
+			}
+		}
+	}
+	// cells on the axes belong to two quadrants
+	std::sort(reachable.begin() + offset, reachable.end());
+	reachable.erase(std::unique(reachable.begin() + offset, reachable.end()), reachable.end());
+}
+
+
+Path SubgoalGraphSearch::findOptimalPath()
+{
+	return findSuboptimalPath();
+}
+
+
+Path SubgoalGraphSearch::findSuboptimalPath()
+{
+	struct Node
+	{
+		int id;
+		int g_val;
+		int f_val;
+
+		Node() = default;
+		Node(int id, int g_val, int f_val) : id(id), g_val(g_val), f_val(f_val) {}
+		struct compare_node
+		{
+			// returns true if n1 > n2 (note -- this gives us *min*-heap).
+			bool operator()(const Node& n1, const Node& n2) const
+			{
+				if (n1.f_val == n2.f_val)
+					return n1.g_val <= n2.g_val;  // break ties towards larger g_vals
+				return n1.f_val >= n2.f_val;
+			}
+		};
+	};
+
+	Path path;
+	num_expanded = 0;
+	num_generated = 0;
+	if (start_location == goal_location)
+	{
+		path.emplace_back(start_location);
+		planned_path = path;
+		path_cost = 0;
+		return path;
+	}
+
+	// abstract nodes: subgoals, followed by start and goal if they are not subgoals themselves
+	int num_of_subgoals = graph.getNumOfSubgoals();
+	int start_id = graph.isSubgoal(start_location) ? graph.subgoal_id[start_location] : num_of_subgoals;
+	int goal_id = graph.isSubgoal(goal_location) ? graph.subgoal_id[goal_location] : num_of_subgoals + 1;
+	vector<int> locations(graph.subgoals);
+	locations.push_back(start_location);
+	locations.push_back(goal_location);
+
+	vector< pair<int, int> > start_edges, goal_edges;
+	if (start_id == num_of_subgoals)
+		graph.getDirectHReachable(start_location, start_edges, goal_location);
+	unordered_map<int, int> goal_costs; // cost from each subgoal to a goal that is not a subgoal
+	if (goal_id == num_of_subgoals + 1)
+	{
+		graph.getDirectHReachable(goal_location, goal_edges, start_location);
+		for (const auto& entry : goal_edges)
+		{
+			int id = entry.first == start_location ? start_id : graph.subgoal_id[entry.first];
+			goal_costs[id] = entry.second;
+		}
+	}
+
+	vector<int> g_vals(num_of_subgoals + 2, MAX_COST);
+	vector<int> parents(num_of_subgoals + 2, -1);
+	boost::heap::pairing_heap< Node, boost::heap::compare<Node::compare_node> > open_list;
+	g_vals[start_id] = 0;
+	open_list.push(Node(start_id, 0, compute_heuristic(start_location, goal_location)));
+	num_generated++;
+
+	auto generate = [&](int curr, int next, int cost)
+	{
+		int next_g_val = g_vals[curr] + cost;
+		if (next_g_val >= g_vals[next])
+			return;
+		g_vals[next] = next_g_val;
+		parents[next] = curr;
+		open_list.push(Node(next, next_g_val, next_g_val + compute_heuristic(locations[next], goal_location)));
+		num_generated++;
+	};
+
+	bool found = false;
+	while (!open_list.empty())
+	{
+		Node curr = open_list.top();
+		open_list.pop();
+		if (curr.g_val > g_vals[curr.id]) // a better copy has been expanded
+			continue;
+		num_expanded++;
+		if (curr.id == goal_id)
+		{
+			found = true;
+			break;
+		}
+
+		if (curr.id == num_of_subgoals) // start is not a subgoal
+		{
+			for (const auto& entry : start_edges)
+				generate(curr.id, entry.first == goal_location ? goal_id : graph.subgoal_id[entry.first], entry.second);
+		}
+		else
+		{
+			for (const auto& entry : graph.edges[curr.id])
+				generate(curr.id, entry.first, entry.second);
+		}
+		auto it = goal_costs.find(curr.id);
+		if (it != goal_costs.end())
+			generate(curr.id, goal_id, it->second);
+	}
+
+	if (found)
+	{
+		vector<int> abstract_path;
+		for (int id = goal_id; id >= 0; id = parents[id])
+			abstract_path.push_back(locations[id]);
+		std::reverse(abstract_path.begin(), abstract_path.end());
+		updatePath(abstract_path, path);
+	}
+
+	planned_path = path;
+	path_cost = path.size() - 1;
+	return path;
+}
+
+
+// refine each abstract edge into a path of Manhattan length
+void SubgoalGraphSearch::updatePath(const vector<int>& abstract_path, vector<PathEntry> &path) const
+{
+	vector<int> locations;
+	locations.push_back(abstract_path.front());
+	for (size_t i = 1; i < abstract_path.size(); i++)
+	{
+		if (!instance.getMonotonePath(abstract_path[i - 1], abstract_path[i], locations))
+		{
+			cerr << "Fail to refine the abstract edge " << abstract_path[i - 1] << "->" << abstract_path[i] << endl;
+			return;
+		}
+	}
+	path.reserve(locations.size());
+	for (int loc : locations)
+		path.emplace_back(loc);
+}
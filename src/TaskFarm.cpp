@@ -0,0 +1,213 @@
+#include <cstring>
+#include <deque>
+#include "TaskFarm.h"
+#include "HDAStar.h"
+
+// rank 0 -> a worker or the first rank of the HDA* group: the trial to solve (int32; -1: stop)
+#define TAG_TRIAL 1
+// a worker or the first rank of the HDA* group -> rank 0: the trial it solved (int32; -1 for the first request), whether
+// it gives the trial up to the HDA* group (int32), then the line of its results (without the newline)
+#define TAG_RESULT 2
+
+
+TaskFarm::TaskFarm(PreprocessedMap& map, SharedInstance& shared_instance, const FarmOptions& options,
+	const string& instance_name):
+	map(map), options(options), instance_name(instance_name)
+{
+	MPI_Comm_rank(MPI_COMM_WORLD, &pid);
+	MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+	num_of_hda_ranks = options.hda_ranks < 0 ? (nproc >= 3 ? 1 : 0) : options.hda_ranks;
+	num_of_workers = nproc - 1 - num_of_hda_ranks;
+	// HDA* on several ranks may return suboptimal paths; its rows have nproc > 1, which the query predictor skips
+	if (pid == 0 && num_of_workers > 0 && num_of_hda_ranks > 1)
+		cerr << "Warning: the costs of HDA* on " << num_of_hda_ranks << " ranks may not be optimal" << endl;
+	bool in_hda_group = num_of_workers > 0 && pid >= nproc - num_of_hda_ranks;
+	MPI_Comm_split(MPI_COMM_WORLD, in_hda_group ? 1 : MPI_UNDEFINED, pid, &hda_comm);
+	if (in_hda_group && map.options.heuristic == "BFS")
+		hda_distances.reset(new SharedGoalDistances(shared_instance.get(), hda_comm));
+}
+
+
+TaskFarm::~TaskFarm()
+{
+	hda_distances.reset();
+	if (hda_comm != MPI_COMM_NULL)
+		MPI_Comm_free(&hda_comm);
+}
+
+
+bool TaskFarm::run(int num_of_trials, ResultWriter* writer)
+{
+	if (num_of_workers < 1)
+		return false;
+	int hda_rank = 0;
+	if (hda_comm != MPI_COMM_NULL)
+		MPI_Comm_rank(hda_comm, &hda_rank);
+	if (pid == 0)
+		schedule(num_of_trials, writer);
+	else if (hda_rank == 0)
+		work();
+	else
+	{
+		// the other ranks of the HDA* group follow the trials of its first rank
+		while (true)
+		{
+			int trial;
+			MPI_Bcast(&trial, 1, MPI_INT, 0, hda_comm);
+			if (trial < 0)
+				break;
+			solveWithHDAStar(trial);
+		}
+	}
+	return true;
+}
+
+
+void TaskFarm::schedule(int num_of_trials, ResultWriter* writer)
+{
+	Timer timer;
+	std::deque<int> trials, hard_trials;
+	for (int i = 0; i < num_of_trials; i++)
+		trials.push_back(i);
+	vector<string> lines(num_of_trials);
+	int hda_leader = num_of_hda_ranks > 0 ? nproc - num_of_hda_ranks : -1;
+	int active_workers = num_of_workers;
+	bool hda_active = hda_leader > 0;
+	bool hda_waiting = false;
+	auto send = [](int trial, int rank) { MPI_Send(&trial, 1, MPI_INT, rank, TAG_TRIAL, MPI_COMM_WORLD); };
+
+	string message;
+	while (active_workers > 0 || hda_active)
+	{
+		MPI_Status status;
+		MPI_Probe(MPI_ANY_SOURCE, TAG_RESULT, MPI_COMM_WORLD, &status);
+		int size;
+		MPI_Get_count(&status, MPI_CHAR, &size);
+		message.resize(size);
+		MPI_Recv(&message[0], size, MPI_CHAR, status.MPI_SOURCE, TAG_RESULT, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		int32_t header[2];
+		memcpy(header, message.data(), sizeof(header));
+		if (header[0] >= 0 && header[1] != 0)
+		{
+			hard_trials.push_back(header[0]);
+			num_of_escalations++;
+		}
+		else if (header[0] >= 0)
+			lines[header[0]] = message.substr(sizeof(header));
+
+		if (status.MPI_SOURCE == hda_leader)
+			hda_waiting = true;
+		else
+		{
+			int trial = -1;
+			while (trial < 0 && !trials.empty())
+			{
+				int next = trials.front();
+				trials.pop_front();
+				if (isPredictedHard(next))
+				{
+					hard_trials.push_back(next);
+					num_of_escalations++;
+					num_of_predictions++;
+				}
+				else
+					trial = next;
+			}
+			send(trial, status.MPI_SOURCE);
+			if (trial < 0)
+				active_workers--;
+		}
+		// the HDA* group waits until there is a hard trial, or until no worker can escalate one
+		if (hda_waiting && !hard_trials.empty())
+		{
+			send(hard_trials.front(), hda_leader);
+			hard_trials.pop_front();
+			hda_waiting = false;
+		}
+		else if (hda_waiting && active_workers == 0)
+		{
+			send(-1, hda_leader);
+			hda_waiting = false;
+			hda_active = false;
+		}
+	}
+
+	if (writer != nullptr)
+		for (const auto& line : lines)
+			writer->addResults(line);
+	if (options.screen > 0)
+		cout << "Task farm: " << num_of_trials << " trials on " << num_of_workers << " A* workers and " <<
+			num_of_hda_ranks << " HDA* ranks, " << num_of_escalations << " escalated (" << num_of_predictions <<
+			" predicted), in " << timer.elapsed() << "s" << endl;
+}
+
+
+void TaskFarm::work()
+{
+	bool hda = hda_comm != MPI_COMM_NULL;
+	std::unique_ptr<SearchContext> context; // reused by the A* searches of this worker
+	if (!hda)
+		context.reset(new SearchContext(map.instance));
+	int32_t header[2] = {-1, 0};
+	string line;
+	while (true)
+	{
+		string message(reinterpret_cast<const char*>(header), sizeof(header));
+		message += line;
+		MPI_Send(&message[0], (int)message.size(), MPI_CHAR, 0, TAG_RESULT, MPI_COMM_WORLD);
+		int trial;
+		MPI_Recv(&trial, 1, MPI_INT, 0, TAG_TRIAL, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		if (hda)
+			MPI_Bcast(&trial, 1, MPI_INT, 0, hda_comm);
+		if (trial < 0)
+			break;
+		bool escalated = false;
+		line = hda ? solveWithHDAStar(trial) : solveWithAStar(trial, *context, escalated);
+		header[0] = trial;
+		header[1] = escalated;
+	}
+}
+
+
+string TaskFarm::solveWithAStar(int trial, SearchContext& context, bool& escalated)
+{
+	Timer timer;
+	std::unique_ptr<SingleAgentSolver> planner(map.createSolver("A*", trial, &context));
+	uint64_t budget = num_of_hda_ranks > 0 && options.escalate_expansions > 0 ? options.escalate_expansions : UINT64_MAX;
+	escalated = static_cast<SpaceTimeAStar*>(planner.get())->step(budget) == SearchStatus::IN_PROGRESS;
+	planner->runtime = timer.elapsed();
+	return escalated ? "" : planner->getResults(instance_name);
+}
+
+
+string TaskFarm::solveWithHDAStar(int trial)
+{
+	int hda_rank, hda_size;
+	MPI_Comm_rank(hda_comm, &hda_rank);
+	MPI_Comm_size(hda_comm, &hda_size);
+	Timer timer;
+	std::unique_ptr<HDAStar> planner(new HDAStar(map.instance, trial, hda_size, hda_rank, hda_comm));
+	if (hda_distances != nullptr)
+		planner->goal_distances = hda_distances->get(planner->goal_location);
+	planner->findOptimalPath();
+	uint64_t counts[2] = {planner->num_expanded, planner->num_generated};
+	uint64_t totals[2];
+	MPI_Reduce(counts, totals, 2, MPI_UINT64_T, MPI_SUM, 0, hda_comm);
+	planner->num_expanded = totals[0];
+	planner->num_generated = totals[1];
+	planner->runtime = timer.elapsed();
+	return hda_rank == 0 ? planner->getResults(instance_name) : "";
+}
+
+
+bool TaskFarm::isPredictedHard(int trial) const
+{
+	if (num_of_hda_ranks == 0 || options.escalate_distance <= 0)
+		return false;
+	const Instance& instance = map.instance;
+	int start = instance.getStartLocation(trial);
+	int goal = instance.getGoalLocation(trial);
+	// the map index answers unreachable goals at once, so they are never hard
+	return instance.map_index.isReachable(start, goal) &&
+		instance.getManhattanDistance(start, goal) >= options.escalate_distance;
+}
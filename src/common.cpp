@@ -1,3 +1,4 @@
+#include <sys/resource.h>
 #include "common.h"
 
 std::ostream& operator<<(std::ostream& os, const Path& path)
@@ -21,3 +22,12 @@ bool isSamePath(const Path& p1, const Path& p2)
 	}
 	return true;
 }
+
+
+size_t getPeakMemoryUsage()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return usage.ru_maxrss; // in KB on Linux
+}
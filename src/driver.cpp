@@ -7,11 +7,84 @@
 /*driver.cpp
 * Solve a MAPF instance on 2D grids.
 */
+#include <map>
 #include <boost/program_options.hpp>
 #include <boost/tokenizer.hpp>
 #include <unistd.h>
-#include "SpaceTimeAStar.h"
+#ifdef USE_MPI
 #include "HDAStar.h"
+#include "SharedInstance.h"
+#include "TaskFarm.h"
+#endif
+#include "MultiSourceBFS.h"
+#include "ResultWriter.h"
+#include "PreprocessedMap.h"
+#include "BidirectionalAStar.h"
+#include "QueryServer.h"
+#include "HeapCounter.h"
+
+
+SolverOptions getSolverOptions(const boost::program_options::variables_map& vm)
+{
+	SolverOptions options;
+	options.num_of_threads = vm["threads"].as<int>();
+	options.cluster_size = vm["clusterSize"].as<int>();
+	options.nblock_size = vm["nblockSize"].as<int>();
+	options.smooth = vm["smooth"].as<bool>();
+	options.max_memory_mb = vm["maxMemoryMB"].as<int>();
+	options.external_dir = vm["externalDir"].as<string>();
+	options.heuristic = vm["heuristic"].as<string>();
+	options.reverse_searches = vm["reverseSearches"].as<int>();
+	options.heuristic_memory_mb = vm["heuristicMemoryMB"].as<int>();
+	options.heuristic_dir = vm["heuristicDir"].as<string>();
+	if (vm.count("abstractGraph"))
+		options.abstract_graph_file = vm["abstractGraph"].as<string>();
+	if (vm.count("boundingBoxes"))
+		options.bounding_boxes_file = vm["boundingBoxes"].as<string>();
+	options.suboptimality = vm["suboptimality"].as<double>();
+	options.parallel_algo = vm["parallelAlgo"].as<string>();
+	options.easy_expansions = vm["easyExpansions"].as<double>();
+	if (vm.count("predictorModel"))
+		options.predictor_model = vm["predictorModel"].as<string>();
+	options.screen = vm["screen"].as<int>();
+	return options;
+}
+
+
+// false (with a message) if algo, its heuristic or the options of wA* and auto are invalid; the options of auto are
+// checked if algo is auto, or for a server, whose queries may ask for auto
+bool checkAlgorithm(const string& algo, const SolverOptions& options, bool server = false)
+{
+	if (!PreprocessedMap::isValidAlgorithm(algo))
+	{
+		cerr << "Unknown algorithm " << algo << endl;
+		return false;
+	}
+	if (!PreprocessedMap::supportsHeuristic(algo, options.heuristic))
+	{
+		cerr << algo << " does not support the " << options.heuristic << " heuristic" << endl;
+		return false;
+	}
+	if (options.suboptimality < 1)
+	{
+		cerr << "The suboptimality must be at least 1" << endl;
+		return false;
+	}
+	if (algo != "auto" && !server)
+		return true;
+	if (!PreprocessedMap::isValidAlgorithm(options.parallel_algo) || options.parallel_algo == "auto")
+	{
+		cerr << "Unknown parallel algorithm " << options.parallel_algo << endl;
+		return false;
+	}
+	if (!PreprocessedMap::supportsHeuristic(options.parallel_algo, options.heuristic))
+	{
+		cerr << options.parallel_algo << " does not support the " << options.heuristic << " heuristic" << endl;
+		return false;
+	}
+	return true;
+}
+
 
 /* Main function */
 int main(int argc, char** argv)
@@ -28,8 +101,36 @@ int main(int argc, char** argv)
 		("agents,a", po::value<string>()->required(), "input file for start/goals")
 		("output,o", po::value<string>(), "output file for statistics")
 		("outputPaths", po::value<string>(), "output file for paths")
-		("algo", po::value<string>()->default_value("A*"), "algorithm of planner (A*, HDA*)")
+		("pathFormat", po::value<string>()->default_value("text"), "format of the output file for paths (text, binary)")
+		("convertPaths", po::value<string>(), "rewrite this binary path file in the text format to the file of --outputPaths, instead of searching")
+		("algo", po::value<string>()->default_value("A*"), "algorithm of planner (A*, wA*, EPEA*, MM, BFHS, ExternalA*, MQA*, GA*, PBNF, SUB, HPA*, BB, HDA*, auto)")
 		("threads,t", po::value<int>()->default_value(1), "number of threads to use")
+		("clusterSize", po::value<int>()->default_value(16), "cluster size of HPA*")
+		("nblockSize", po::value<int>()->default_value(16), "nblock size of PBNF")
+		("abstractGraph", po::value<string>(), "file to load (or save) the abstract graph of HPA*")
+		("boundingBoxes", po::value<string>(), "file to load (or save) the bounding boxes of BB")
+		("smooth", po::value<bool>()->default_value(false), "smooth the paths of HPA*")
+		("heuristic", po::value<string>()->default_value("Manhattan"), "heuristic (Manhattan, RRA*, BFS)")
+		("reverseSearches", po::value<int>()->default_value(16), "number of goals whose RRA* searches are kept")
+		("heuristicMemoryMB", po::value<int>()->default_value(256), "memory budget of the BFS heuristic tables (MB)")
+		("heuristicDir", po::value<string>()->default_value(""), "directory in which the BFS heuristic tables are saved and memory-mapped")
+		("suboptimality", po::value<double>()->default_value(1), "weight of the heuristic of wA* (paths cost at most this times the optimum), also used by auto on the queries that are not easy if it is above 1")
+		("parallelAlgo", po::value<string>()->default_value("MQA*"), "algorithm of auto on the queries that are not easy, with several threads and --suboptimality=1")
+		("easyExpansions", po::value<double>()->default_value(100000), "auto runs A* on the queries predicted to expand at most this many nodes")
+		("predictorModel", po::value<string>(), "file of the weights of the query predictor of auto")
+		("calibrate", po::value<string>(), "fit the query predictor to the A* results of the trials in this results file and save it to --predictorModel, instead of searching")
+		("maxMemoryMB", po::value<int>()->default_value(1024), "memory budget of BFHS and ExternalA* (MB)")
+		("externalDir", po::value<string>()->default_value("/tmp"), "directory for the bucket files of ExternalA*")
+		("saveBinaryMap", po::value<string>(), "save the map as a binary map file that can be memory-mapped by --map")
+		("stepBudget", po::value<int>()->default_value(0), "expansions per step of the resumable A* (0: run to completion in one call)")
+		("tileSize", po::value<int>()->default_value(1), "side of the square tiles in which locations are numbered (a power of two; 1: row-major)")
+		("server", po::value<string>(), "answer queries on the maps of --map and --serverMaps from stdin or a Unix domain socket (stdin or the socket path), instead of solving the trials")
+		("serverMaps", po::value<string>(), "comma-separated additional maps of the server (map 1, 2, ...)")
+		("distanceMatrix", po::value<string>(), "write the distances from the start locations to the goal locations of the trials to this binary file, instead of searching")
+		("taskFarm", po::value<bool>()->default_value(false), "with HDA*, rank 0 hands the trials out to ranks running A* and the hard ones to a group of ranks running HDA*, instead of all ranks running HDA* on every trial")
+		("escalateExpansions", po::value<int>()->default_value(100000), "expansions after which a worker of the task farm gives a trial up to the HDA* group (0: never)")
+		("escalateDistance", po::value<int>()->default_value(0), "Manhattan distance from which the task farm sends trials to the HDA* group without trying A* (0: never)")
+		("hdaRanks", po::value<int>()->default_value(-1), "ranks of the HDA* group of the task farm (-1: one rank if there are at least three; more ranks may give suboptimal costs)")
 		("trialNum,k", po::value<int>()->default_value(1), "number of trials")
 		("cutoffTime", po::value<double>()->default_value(60), "cutoff time (seconds)")
 		("screen,s", po::value<int>()->default_value(1), "screen option (0: none; 1: results; 2:all)")
@@ -43,34 +144,80 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
+	// results are only appended to a file with the same columns, so a mismatch is reported before any search
+	if (vm.count("output") && !ResultWriter::hasCurrentColumns(vm["output"].as<string>()))
+	{
+		cerr << "The columns of " << vm["output"].as<string>() << " differ from the current ones (" <<
+			SingleAgentSolver::results_header << "); use another output file" << endl;
+		return -1;
+	}
+
+	if (vm.count("convertPaths"))
+	{
+		if (!vm.count("outputPaths"))
+		{
+			cerr << "--convertPaths requires --outputPaths" << endl;
+			return -1;
+		}
+		return convertPaths(vm["convertPaths"].as<string>(), vm["outputPaths"].as<string>()) ? 0 : -1;
+	}
+
+	if (vm.count("server"))
+	{
+		// the queries give their own start and goal, so no agent file is needed
+		if (!vm.count("map"))
+		{
+			cerr << "--server requires --map" << endl;
+			return -1;
+		}
+		SolverOptions options = getSolverOptions(vm);
+		if (vm["server"].as<string>() == "stdin")
+			options.screen = 0; // stdout carries the responses
+		if (options.heuristic != "Manhattan" && options.heuristic != "BFS")
+		{
+			cerr << "The server supports the Manhattan and BFS heuristics" << endl; // RRA* searches are not thread-safe
+			return -1;
+		}
+		if (!checkAlgorithm(vm["algo"].as<string>(), options, true))
+			return -1;
+		vector<string> map_names{vm["map"].as<string>()};
+		if (vm.count("serverMaps"))
+		{
+			boost::char_separator<char> sep(",");
+			boost::tokenizer< boost::char_separator<char> > tok(vm["serverMaps"].as<string>(), sep);
+			map_names.insert(map_names.end(), tok.begin(), tok.end());
+		}
+		vector< std::unique_ptr<Instance> > instances;
+		vector< std::unique_ptr<PreprocessedMap> > preprocessed_maps;
+		vector<PreprocessedMap*> maps;
+		for (const auto& map_name : map_names)
+		{
+			instances.emplace_back(new Instance(map_name, "", 0, 0, 0, 0, 0, vm["tileSize"].as<int>()));
+			preprocessed_maps.emplace_back(new PreprocessedMap(*instances.back(), options));
+			if (!preprocessed_maps.back()->prepare(vm["algo"].as<string>()))
+				return -1;
+			maps.push_back(preprocessed_maps.back().get());
+		}
+		QueryServer server(maps, vm["algo"].as<string>(), vm["threads"].as<int>());
+		return server.run(vm["server"].as<string>()) ? 0 : -1;
+	}
+
 	po::notify(vm);
+	if (vm["pathFormat"].as<string>() != "text" && vm["pathFormat"].as<string>() != "binary")
+	{
+		cerr << "Unknown path format " << vm["pathFormat"].as<string>() << endl;
+		return -1;
+	}
 
 	int theSeed = vm["seed"].as<int>();
 	srand(theSeed);
 
-	///////////////////////////////////////////////////////////////////////////
-	// load the instance
-	Instance instance(vm["map"].as<string>(), vm["agents"].as<string>(),
-		vm["trialNum"].as<int>());
-	//////////////////////////////////////////////////////////////////////
-    // initialize the solver
-	if (vm["algo"].as<string>() == "A*")
+	if (vm["algo"].as<string>() == "HDA*")
 	{
-		for (int i=0; i < vm["trialNum"].as<int>(); i++) {
-			Timer timer;
-			SpaceTimeAStar* planner = new SpaceTimeAStar(instance, i);
-			Path path = planner->findOptimalPath();
-			float runtime = timer.elapsed();
-			planner->runtime = runtime; 
-			if (vm.count("output"))
-				planner->saveResults(vm["output"].as<string>(), vm["agents"].as<string>());
-			if (vm.count("outputPaths"))
-				planner->savePaths(vm["outputPaths"].as<string>());
-			delete planner;
-		}
-	}
-	else if (vm["algo"].as<string>() == "HDA*")
-	{	
+#ifndef USE_MPI
+		cerr << "HDA* needs a build with MPI (USE_MPI)" << endl;
+		return -1;
+#else
 		if (vm["debugwait"].as<int>())
 			sleep(15);
 
@@ -80,39 +227,242 @@ int main(int argc, char** argv)
 		MPI_Init(&argc, &argv);
 		MPI_Comm_rank(MPI_COMM_WORLD, &pid);
 		MPI_Comm_size(MPI_COMM_WORLD, &nproc);
-		for (int i=0; i < vm["trialNum"].as<int>(); i++) {
-			MPI_Barrier(MPI_COMM_WORLD);
+		if (vm["heuristic"].as<string>() != "Manhattan" && vm["heuristic"].as<string>() != "BFS")
+		{
+			if (pid == 0)
+				cerr << "HDA* only supports the Manhattan and BFS heuristics" << endl;
+			MPI_Finalize();
+			return -1;
+		}
+		bool succ = true;
+		{
+			// one copy of the instance (and of the heuristic table of the current goal) per node
+			SharedInstance shared_instance(MPI_COMM_WORLD, vm["map"].as<string>(), vm["agents"].as<string>(),
+				vm["trialNum"].as<int>(), vm["tileSize"].as<int>());
+			const Instance& instance = shared_instance.get();
+			if (pid == 0 && vm["screen"].as<int>() > 0)
+				cout << "Shared instance: " << shared_instance.shared_size << " bytes per node of " <<
+					shared_instance.num_of_node_ranks << " ranks, loaded in " << shared_instance.loading_time << "s" << endl;
+			std::unique_ptr<ResultWriter> writer;
+			if (pid == 0)
+				writer.reset(new ResultWriter(instance, vm.count("output") ? vm["output"].as<string>() : "",
+					vm["agents"].as<string>(), "", false));
+			if (vm["taskFarm"].as<bool>())
+			{
+				SolverOptions options = getSolverOptions(vm);
+				options.screen = 0;
+				PreprocessedMap preprocessed_map(instance, options);
+				FarmOptions farm_options;
+				farm_options.escalate_expansions = vm["escalateExpansions"].as<int>();
+				farm_options.escalate_distance = vm["escalateDistance"].as<int>();
+				farm_options.hda_ranks = vm["hdaRanks"].as<int>();
+				farm_options.screen = vm["screen"].as<int>();
+				TaskFarm farm(preprocessed_map, shared_instance, farm_options, vm["agents"].as<string>());
+				succ = farm.run(vm["trialNum"].as<int>(), writer.get());
+				if (!succ && pid == 0)
+					cerr << "The task farm needs a rank for the scheduler and a rank for A* besides the HDA* group" << endl;
+			}
+			else
+			{
+				for (int i=0; i < vm["trialNum"].as<int>(); i++) {
+					MPI_Barrier(MPI_COMM_WORLD);
 
-			Timer timer;
-			HDAStar* planner = new HDAStar(instance, i, nproc, pid);
-			Path path = planner->findOptimalPath();
-			MPI_Barrier(MPI_COMM_WORLD);
+					Timer timer;
+					HDAStar* planner = new HDAStar(instance, i, nproc, pid);
+					if (vm["heuristic"].as<string>() == "BFS")
+						planner->goal_distances = shared_instance.getGoalDistances(planner->goal_location);
+					Path path = planner->findOptimalPath();
+					MPI_Barrier(MPI_COMM_WORLD);
 
-			if (pid == 0) { // should be the process that find goal
-				float runtime = timer.elapsed();
-				planner->runtime = runtime; 
-			}
+					if (pid == 0) { // should be the process that find goal
+						float runtime = timer.elapsed();
+						planner->runtime = runtime; 
+					}
 
-			// gather the total node from all process
-			int recv_node_gen[nproc]; int recv_node_exp[nproc];
-			MPI_Gather(&planner->num_generated, 1, MPI_INT, &recv_node_gen, 1, MPI_INT, 0, MPI_COMM_WORLD);
-			MPI_Gather(&planner->num_expanded, 1, MPI_INT, &recv_node_exp, 1, MPI_INT, 0, MPI_COMM_WORLD);
-			planner->num_expanded = 0; planner->num_generated = 0;
-			for (int p=0; p<nproc; p++) {
-				planner->num_expanded += recv_node_exp[p];
-				planner->num_generated += recv_node_gen[p];
+					// gather the total node from all process
+					int recv_node_gen[nproc]; int recv_node_exp[nproc];
+					MPI_Gather(&planner->num_generated, 1, MPI_INT, &recv_node_gen, 1, MPI_INT, 0, MPI_COMM_WORLD);
+					MPI_Gather(&planner->num_expanded, 1, MPI_INT, &recv_node_exp, 1, MPI_INT, 0, MPI_COMM_WORLD);
+					planner->num_expanded = 0; planner->num_generated = 0;
+					for (int p=0; p<nproc; p++) {
+						planner->num_expanded += recv_node_exp[p];
+						planner->num_generated += recv_node_gen[p];
+					}
+
+					if (pid == 0)
+						writer->addResults(*planner);
+					delete planner;
+				
+				}
 			}
+		}
+		MPI_Finalize();
+		return succ ? 0 : -1;
+#endif
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// load the instance
+	Instance instance(vm["map"].as<string>(), vm["agents"].as<string>(),
+		vm["trialNum"].as<int>(), 0, 0, 0, 0, vm["tileSize"].as<int>());
+	if (vm.count("saveBinaryMap") && !instance.saveBinaryMap(vm["saveBinaryMap"].as<string>()))
+		cerr << "Fail to save the binary map to " << vm["saveBinaryMap"].as<string>() << endl;
+	if (vm["screen"].as<int>() > 1)
+		cout << "Map index: " << instance.map_index.num_of_components << " components, " <<
+			instance.map_index.num_of_blocks << " blocks, " << instance.map_index.num_of_articulations <<
+			" articulation cells, built in " << instance.map_index.preprocessing_time << "s" << endl;
+	if (vm.count("distanceMatrix"))
+	{
+		int num_of_trials = vm["trialNum"].as<int>();
+		vector<int> starts(num_of_trials), goals(num_of_trials), distances;
+		for (int i = 0; i < num_of_trials; i++)
+		{
+			starts[i] = instance.getStartLocation(i);
+			goals[i] = instance.getGoalLocation(i);
+		}
+		MultiSourceBFS bfs(instance, vm["threads"].as<int>());
+		bfs.computeDistances(starts, goals, distances);
+		if (!saveDistanceMatrix(vm["distanceMatrix"].as<string>(), num_of_trials, num_of_trials, distances))
+		{
+			cerr << "Fail to save the distance matrix to " << vm["distanceMatrix"].as<string>() << endl;
+			return -1;
+		}
+		if (vm["screen"].as<int>() > 0)
+			cout << "Distance matrix: " << num_of_trials << " x " << num_of_trials << ", computed in " << bfs.runtime <<
+				"s" << endl;
+		return 0;
+	}
+	if (vm.count("calibrate"))
+	{
+		if (!vm.count("predictorModel"))
+		{
+			cerr << "--calibrate requires --predictorModel" << endl;
+			return -1;
+		}
+		QueryPredictor predictor(instance, 8, vm["threads"].as<int>());
+		double rms_error;
+		int num_of_samples = predictor.calibrate(vm["calibrate"].as<string>(), vm["agents"].as<string>(), rms_error);
+		if (num_of_samples == 0)
+		{
+			cerr << "Too few results of the trials of " << vm["agents"].as<string>() << " in " <<
+				vm["calibrate"].as<string>() << endl;
+			return -1;
+		}
+		if (!predictor.save(vm["predictorModel"].as<string>()))
+		{
+			cerr << "Fail to save the predictor model to " << vm["predictorModel"].as<string>() << endl;
+			return -1;
+		}
+		if (vm["screen"].as<int>() > 0)
+			cout << "Query predictor: calibrated on " << num_of_samples << " trials, RMS error " << rms_error <<
+				" (log2 of the expansions)" << endl;
+		return 0;
+	}
+	//////////////////////////////////////////////////////////////////////
+    // initialize the solver
+	{
+		// preprocessing shared by all trials
+		SolverOptions options = getSolverOptions(vm);
+		if (options.heuristic != "Manhattan" && options.heuristic != "RRA*" && options.heuristic != "BFS")
+		{
+			cerr << "Unknown heuristic " << options.heuristic << endl;
+			return -1;
+		}
+		if (!checkAlgorithm(vm["algo"].as<string>(), options))
+			return -1;
+		PreprocessedMap preprocessed_map(instance, options);
+		if (!preprocessed_map.prepare(vm["algo"].as<string>()))
+			return -1;
+
+		// scratch memory of the low-level searches, reused by all trials
+		std::unique_ptr<SearchContext> search_context;
+		if (PreprocessedMap::usesSearchContext(vm["algo"].as<string>()))
+			search_context.reset(new SearchContext(instance));
+		uint64_t steady_state_allocations = 0; // in the searches of all trials but the first
+		ResultWriter writer(instance, vm.count("output") ? vm["output"].as<string>() : "", vm["agents"].as<string>(),
+			vm.count("outputPaths") ? vm["outputPaths"].as<string>() : "", vm["pathFormat"].as<string>() == "binary");
 
-			if (pid == 0) {
-				if (vm.count("output"))
-					planner->saveResults(vm["output"].as<string>(), vm["agents"].as<string>());
-				// if (vm.count("outputPaths"))
-				// 	planner->savePaths(vm["outputPaths"].as<string>());
+		std::map<string, int> num_of_selections; // by the algorithms that auto chose
+		uint64_t num_of_expanded_forward = 0, num_of_expanded_backward = 0; // by the directions of MM
+		for (int i=0; i < vm["trialNum"].as<int>(); i++) {
+			Timer timer;
+			string algo = vm["algo"].as<string>();
+			if (algo == "auto")
+			{
+				algo = preprocessed_map.selectAlgorithm(instance.getStartLocation(i), instance.getGoalLocation(i));
+				num_of_selections[algo]++;
+				if (vm["screen"].as<int>() > 1)
+					cout << "Trial " << i << ": " << algo << endl;
+			}
+			SingleAgentSolver* planner = preprocessed_map.createSolver(algo, i, search_context.get());
+			auto resumable = dynamic_cast<SpaceTimeAStar*>(planner);
+			uint64_t allocations = getNumOfHeapAllocations();
+			if (resumable != nullptr)
+			{
+				// time-sliced search, as called from a game loop (the path stays in the search context)
+				uint64_t budget = vm["stepBudget"].as<int>() > 0 ? vm["stepBudget"].as<int>() : UINT64_MAX;
+				double max_step_time = 0;
+				int num_of_steps = 0;
+				SearchStatus status;
+				do
+				{
+					Timer step_timer;
+					status = resumable->step(budget);
+					max_step_time = max(max_step_time, step_timer.elapsed());
+					num_of_steps++;
+				} while (status == SearchStatus::IN_PROGRESS);
+				allocations = getNumOfHeapAllocations() - allocations;
+				if (vm["screen"].as<int>() > 1)
+					cout << "Trial " << i << ": " << num_of_steps << " steps, longest step " << max_step_time * 1e6 <<
+						"us, min f-val " << resumable->getMinFVal() << ", " << allocations << " heap allocations" << endl;
+				resumable->planned_path = resumable->getPath();
 			}
+			else
+			{
+				planner->findOptimalPath();
+				allocations = getNumOfHeapAllocations() - allocations;
+				auto bidirectional = dynamic_cast<BidirectionalAStar*>(planner);
+				if (bidirectional != nullptr)
+				{
+					num_of_expanded_forward += bidirectional->num_expanded_forward;
+					num_of_expanded_backward += bidirectional->num_expanded_backward;
+				}
+				if (vm["screen"].as<int>() > 1)
+				{
+					cout << "Trial " << i << ": " << allocations << " heap allocations";
+					if (bidirectional != nullptr)
+						cout << ", " << bidirectional->num_expanded_forward << " forward and " <<
+							bidirectional->num_expanded_backward << " backward expansions";
+					cout << endl;
+				}
+			}
+			if (i > 0)
+				steady_state_allocations += allocations;
+			float runtime = timer.elapsed();
+			planner->runtime = runtime; 
+			writer.addResults(*planner);
+			writer.addPath(*planner);
 			delete planner;
-			
 		}
-		MPI_Finalize();
+		if (vm["screen"].as<int>() > 0 && vm["trialNum"].as<int>() > 1)
+			cout << "Heap allocations per search after the first trial: " <<
+				(double)steady_state_allocations / (vm["trialNum"].as<int>() - 1) << endl;
+		if (vm["screen"].as<int>() > 0 && num_of_expanded_forward + num_of_expanded_backward > 0)
+			cout << "MM expansions: " << num_of_expanded_forward << " forward, " << num_of_expanded_backward <<
+				" backward" << endl;
+		if (vm["screen"].as<int>() > 0 && !num_of_selections.empty())
+		{
+			cout << "Algorithms chosen by auto:";
+			for (const auto& selection : num_of_selections)
+				cout << " " << selection.first << " " << selection.second;
+			cout << endl;
+		}
+		const HeuristicCache* heuristic_tables = preprocessed_map.getHeuristicTables();
+		if (vm["screen"].as<int>() > 0 && heuristic_tables != nullptr)
+			cout << "Heuristic tables: " << heuristic_tables->num_of_hits << " hits, " << heuristic_tables->num_of_misses <<
+				" misses (" << heuristic_tables->num_of_loads << " loaded from files), " <<
+				heuristic_tables->num_of_evictions << " evictions, " << heuristic_tables->computation_time <<
+				"s of BFS" << endl;
 	}
 
 	
@@ -0,0 +1,161 @@
+#include <atomic>
+#include <thread>
+#include "pastar.h"
+#include "PreprocessedMap.h"
+
+namespace pastar
+{
+
+struct Planner::Impl
+{
+	std::unique_ptr<Instance> instance;
+	std::unique_ptr<PreprocessedMap> map;
+	string algorithm;
+	vector< std::unique_ptr<SearchContext> > contexts; // of the workers of solveBatch (contexts[0] is also used by solve)
+
+	Impl(Instance* instance, const Options& options);
+
+	Result solve(const Query& query, Cell* path, int capacity, const string& algo, int worker);
+};
+
+
+static bool isValid(const Options& options)
+{
+	return PreprocessedMap::isValidAlgorithm(options.algorithm) &&
+		(options.heuristic == "Manhattan" || options.heuristic == "BFS") &&
+		PreprocessedMap::supportsHeuristic(options.algorithm, options.heuristic) && options.suboptimality >= 1 &&
+		options.tile_size > 0 && (options.tile_size & (options.tile_size - 1)) == 0;
+}
+
+
+Planner::Impl::Impl(Instance* instance, const Options& options): instance(instance), algorithm(options.algorithm)
+{
+	SolverOptions solver_options;
+	solver_options.num_of_threads = options.num_of_threads;
+	solver_options.cluster_size = options.cluster_size;
+	solver_options.heuristic = options.heuristic;
+	solver_options.heuristic_memory_mb = options.heuristic_memory_mb;
+	solver_options.heuristic_dir = options.heuristic_dir;
+	solver_options.suboptimality = options.suboptimality;
+	solver_options.predictor_model = options.predictor_model;
+	solver_options.screen = 0;
+	map.reset(new PreprocessedMap(*instance, solver_options));
+	contexts.resize(1);
+}
+
+
+std::unique_ptr<Planner> Planner::load(const std::string& map_file, const Options& options)
+{
+	if (!isValid(options) || !std::ifstream(map_file).good())
+		return nullptr;
+	std::unique_ptr<Instance> instance(new Instance(map_file, "", 0, 0, 0, 0, 0, options.tile_size));
+	if (instance->num_of_rows <= 0 || instance->num_of_cols <= 0) // not a map file
+		return nullptr;
+	std::unique_ptr<Impl> impl(new Impl(instance.release(), options));
+	if (!impl->map->prepare(impl->algorithm))
+		return nullptr;
+	return std::unique_ptr<Planner>(new Planner(std::move(impl)));
+}
+
+
+std::unique_ptr<Planner> Planner::create(int num_of_rows, int num_of_cols, const uint8_t* obstacles,
+	const Options& options)
+{
+	if (!isValid(options) || num_of_rows <= 0 || num_of_cols <= 0 || obstacles == nullptr)
+		return nullptr;
+	std::unique_ptr<Impl> impl(new Impl(new Instance(num_of_rows, num_of_cols, obstacles, options.tile_size), options));
+	if (!impl->map->prepare(impl->algorithm))
+		return nullptr;
+	return std::unique_ptr<Planner>(new Planner(std::move(impl)));
+}
+
+
+Planner::Planner(std::unique_ptr<Impl> impl): impl(std::move(impl)) {}
+
+Planner::~Planner() = default;
+
+int Planner::getNumOfRows() const { return impl->instance->num_of_rows; }
+
+int Planner::getNumOfCols() const { return impl->instance->num_of_cols; }
+
+
+Result Planner::solve(const Query& query, Cell* path, int capacity, const std::string& algorithm)
+{
+	return impl->solve(query, path, capacity, algorithm.empty() ? impl->algorithm : algorithm, 0);
+}
+
+
+void Planner::solveBatch(const Query* queries, int num_of_queries, Cell* paths, int capacity, Result* results,
+	int num_of_threads, const std::string& algorithm)
+{
+	const string& algo = algorithm.empty() ? impl->algorithm : algorithm;
+	int num_of_workers = max(1, min(num_of_threads, num_of_queries));
+	if ((int)impl->contexts.size() < num_of_workers)
+		impl->contexts.resize(num_of_workers);
+	std::atomic<int> next_query(0);
+	auto worker = [&](int id)
+	{
+		for (int i = next_query++; i < num_of_queries; i = next_query++)
+			results[i] = impl->solve(queries[i], paths + (size_t)i * capacity, capacity, algo, id);
+	};
+	vector<std::thread> threads;
+	for (int i = 1; i < num_of_workers; i++)
+		threads.emplace_back(worker, i);
+	worker(0);
+	for (auto& thread : threads)
+		thread.join();
+}
+
+
+Result Planner::Impl::solve(const Query& query, Cell* path, int capacity, const string& algo, int worker)
+{
+	Result result;
+	auto isFree = [&](const Cell& cell)
+	{
+		return cell.row >= 0 && cell.row < instance->num_of_rows && cell.col >= 0 && cell.col < instance->num_of_cols &&
+			!instance->isObstacle(instance->linearizeCoordinate(cell.row, cell.col));
+	};
+	if (!PreprocessedMap::isValidAlgorithm(algo) || !PreprocessedMap::supportsHeuristic(algo, map->options.heuristic) ||
+		!isFree(query.start) || !isFree(query.goal))
+		return result;
+
+	SearchContext* context = nullptr;
+	if (PreprocessedMap::usesSearchContext(algo))
+	{
+		if (contexts[worker] == nullptr)
+			contexts[worker].reset(new SearchContext(*instance));
+		context = contexts[worker].get();
+	}
+	Timer timer;
+	std::unique_ptr<SingleAgentSolver> planner(map->createSolver(algo, 0, context,
+		instance->linearizeCoordinate(query.start.row, query.start.col),
+		instance->linearizeCoordinate(query.goal.row, query.goal.col)));
+	if (planner == nullptr) // algo cannot be prepared for this map
+		return result;
+	// the resumable searches leave their paths in the context, which saves a copy
+	auto resumable = dynamic_cast<SpaceTimeAStar*>(planner.get());
+	Path found;
+	if (resumable != nullptr)
+		while (resumable->step(UINT64_MAX) == SearchStatus::IN_PROGRESS) {}
+	else
+		found = planner->findOptimalPath();
+	const Path& solution = resumable != nullptr ? resumable->getPath() : found;
+	result.runtime = timer.elapsed();
+	result.num_expanded = planner->num_expanded;
+	result.num_generated = planner->num_generated;
+	result.path_length = (int)solution.size();
+	result.cost = result.path_length - 1;
+	if (solution.empty())
+		result.status = UNSOLVED;
+	else if (result.path_length > capacity)
+		result.status = PATH_BUFFER_TOO_SMALL;
+	else
+	{
+		result.status = SOLVED;
+		for (int i = 0; i < result.path_length; i++)
+			path[i] = {instance->getRowCoordinate(solution[i].location), instance->getColCoordinate(solution[i].location)};
+	}
+	return result;
+}
+
+}